@@ -0,0 +1,60 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "PMW3360.h"
+
+PMW3360_data data;
+
+int main()
+{
+    // Initialize PMW3360 sensor, uploads the firmware in a handful of SPI_IOC_MESSAGE calls
+    if (!PMW3360_init()) {
+        fprintf(stderr, "PMW3360 initialization failed, check the spidev device and its permissions\n");
+        return 1;
+    }
+
+    // main loop
+    while (1) {
+        // Read data from PMW3360 sensor, one SPI_IOC_MESSAGE per read
+        if (!PMW3360_read(&data)) {
+            perror("PMW3360 read");
+            PMW3360_shutdown();
+            return 1;
+        }
+
+        // Print motion when the sensor detects it
+        if (data.motion) {
+#if PMW3360_ENABLE_DIAGNOSTICS
+            printf("dx %6d dy %6d squal %3u\n", data.dx, data.dy, data.SQUAL);
+#else
+            printf("dx %6d dy %6d\n", data.dx, data.dy);
+#endif
+        }
+
+        // Wait 1ms
+        usleep(1000);
+    }
+}
@@ -0,0 +1,139 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+
+#include "PMW3360.h"
+#include "PMW3360_pipeline.h"
+
+#define PIN_LED         25
+
+#define SAMPLE_PERIOD   1000    // Sensor sample period in microseconds
+#define REPORT_PERIOD   100     // Report period in milliseconds
+
+PMW3360_pipeline pipeline;
+
+// Samples core1 could not start on time, written by core1 and read by core0
+atomic_uint missed;
+
+/*
+ * Core1 owns the sensor and reads it at a fixed rate.
+ */
+void core1_main()
+{
+    absolute_time_t next;
+    uint32_t period;
+
+    // Initialize PMW3360 sensor, core0 waits on the published state
+    if (!PMW3360_pipeline_start(&pipeline)) {
+        return;
+    }
+
+    // Sample loop, deadlines are absolute so the rate does not drift with read time
+    next = get_absolute_time();
+    while (1) {
+        period = PMW3360_pipeline_step(&pipeline, time_us_32());
+        next = delayed_by_us(next, period);
+
+        // A step that ran past the next deadline is counted, the schedule restarts from now instead of catching up
+        if (time_reached(next)) {
+            // Only core1 writes it, so a plain load and store avoids the read-modify-write the M0+ lacks
+            atomic_store_explicit(&missed, atomic_load_explicit(&missed, memory_order_relaxed) + 1,
+                                  memory_order_relaxed);
+            next = get_absolute_time();
+        }
+        else {
+            busy_wait_until(next);
+        }
+    }
+}
+
+int main()
+{
+    PMW3360_sample sample;
+    int32_t x = 0;
+    int32_t y = 0;
+    uint16_t dpi = 800;
+    absolute_time_t report;
+    int c;
+
+    // Initialize LED pin
+    gpio_init(PIN_LED);
+    gpio_set_dir(PIN_LED, GPIO_OUT);
+    gpio_put(PIN_LED, 0);
+
+    // Initialize chosen serial port
+    stdio_init_all();
+
+    // Wait 10ms at startup for everything to settle
+    sleep_ms(10);
+
+    // Hand the sensor to core1
+    PMW3360_pipeline_init(&pipeline, SAMPLE_PERIOD);
+    multicore_launch_core1(core1_main);
+    while (atomic_load(&pipeline.state) == PMW3360_PIPELINE_STARTING) {
+        tight_loop_contents();
+    }
+    if (atomic_load(&pipeline.state) == PMW3360_PIPELINE_FAILED) {
+        // Error while initializing, blink LED
+        while (1) {
+            gpio_put(PIN_LED, 1);
+            sleep_ms(1000);
+            gpio_put(PIN_LED, 0);
+            sleep_ms(1000);
+        }
+    }
+
+    // main loop, core0 only consumes samples and builds reports
+    report = make_timeout_time_ms(REPORT_PERIOD);
+    while (1) {
+        // Accumulate every sample from core1
+        while (PMW3360_pipeline_pop(&pipeline, &sample)) {
+            x += sample.data.dx;
+            y += sample.data.dy;
+            gpio_put(PIN_LED, sample.data.motion);
+        }
+
+        // '+' and '-' on the serial port change the DPI on core1
+        c = getchar_timeout_us(0);
+        if (c == '+' && dpi < 12000) {
+            dpi += 100;
+            PMW3360_pipeline_command(&pipeline, PMW3360_PIPELINE_CMD_DPI, dpi);
+        }
+        else if (c == '-' && dpi > 100) {
+            dpi -= 100;
+            PMW3360_pipeline_command(&pipeline, PMW3360_PIPELINE_CMD_DPI, dpi);
+        }
+
+        // Report the accumulated motion
+        if (time_reached(report)) {
+            printf("x %ld y %ld dpi %u overruns %lu errors %lu missed %lu\n", (long)x, (long)y, dpi,
+                   (unsigned long)PMW3360_pipeline_overruns(&pipeline),
+                   (unsigned long)PMW3360_pipeline_readErrors(&pipeline),
+                   (unsigned long)atomic_load_explicit(&missed, memory_order_relaxed));
+            report = make_timeout_time_ms(REPORT_PERIOD);
+        }
+    }
+}
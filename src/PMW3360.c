@@ -21,31 +21,204 @@
  * SOFTWARE.
  */
 
+// The spidev port needs POSIX clocks, this must come before any system header to take effect
+#if defined(__linux__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include <stdint.h>
 #include <stdbool.h>
 
 #include "PMW3360.h"
+#define PMW3360_PORT_IMPLEMENTATION
 #include "PMW3360_port.h"
 #include "PMW3360_firmware.h"
 
+// Registers mirrored in the shadow cache, so writes of unchanged values can be skipped
+static const uint8_t PMW3360_cachedRegisters[] = {
+    PMW3360_REG_CONFIG1,
+    PMW3360_REG_ANGLE_TUNE,
+    PMW3360_REG_RUN_DOWNSHIFT,
+    PMW3360_REG_REST1_RATE_LOWER,
+    PMW3360_REG_REST1_RATE_UPPER,
+    PMW3360_REG_REST1_DOWNSHIFT,
+    PMW3360_REG_REST2_RATE_LOWER,
+    PMW3360_REG_REST2_RATE_UPPER,
+    PMW3360_REG_REST2_DOWNSHIFT,
+    PMW3360_REG_REST3_RATE_LOWER,
+    PMW3360_REG_REST3_RATE_UPPER,
+    PMW3360_REG_MIN_SQ_RUN,
+    PMW3360_REG_RAW_DATA_THRESHOLD,
+    PMW3360_REG_ANGLE_SNAP,
+    PMW3360_REG_LIFTCUTOFF_TUNE1,
+    PMW3360_REG_LIFTCUTOFF_TUNE2,
+    PMW3360_REG_LIFT_CONFIG,
+    PMW3360_REG_CONFIG2,
+};
+
+#define PMW3360_CACHE_SIZE      (sizeof(PMW3360_cachedRegisters))
+
+// Power-up values of the cached registers the driver does not write during init, seeded after a hard reset
+static const PMW3360_regValue PMW3360_resetValues[] = {
+    { PMW3360_REG_ANGLE_TUNE, 0x00 },
+    { PMW3360_REG_RUN_DOWNSHIFT, 0x32 },
+    { PMW3360_REG_REST1_RATE_LOWER, 0x00 },
+    { PMW3360_REG_REST1_RATE_UPPER, 0x00 },
+    { PMW3360_REG_REST1_DOWNSHIFT, 0x1f },
+    { PMW3360_REG_REST2_RATE_LOWER, 0x63 },
+    { PMW3360_REG_REST2_RATE_UPPER, 0x00 },
+    { PMW3360_REG_REST2_DOWNSHIFT, 0xbc },
+    { PMW3360_REG_REST3_RATE_LOWER, 0xf3 },
+    { PMW3360_REG_REST3_RATE_UPPER, 0x01 },
+    { PMW3360_REG_ANGLE_SNAP, 0x00 },
+    { PMW3360_REG_LIFTCUTOFF_TUNE2, 0x00 },
+    { PMW3360_REG_LIFT_CONFIG, 0x02 },
+};
+
+// The snapshot must hold every cached register
+typedef char PMW3360_snapshotSizeCheck[PMW3360_CACHE_SIZE == PMW3360_SNAPSHOT_SIZE ? 1 : -1];
+
+// Motion burst bytes read by PMW3360_read, the surface fields are skipped without diagnostics
+#if PMW3360_ENABLE_DIAGNOSTICS
+#define PMW3360_BURST_LENGTH    12
+#else
+#define PMW3360_BURST_LENGTH    6
+#endif
+
+// Currently selected sensor
+static uint8_t PMW3360_sensor;
+
+// Shadow copies of the cached registers and a bit per register set when the copy is valid
+static uint8_t PMW3360_cache[PMW3360_SENSOR_COUNT][PMW3360_CACHE_SIZE];
+static uint32_t PMW3360_cacheValid[PMW3360_SENSOR_COUNT];
+
+// Delay owed to each sensor before its next transaction, paid lazily by PMW3360_settle
+static uint32_t PMW3360_holdoff[PMW3360_SENSOR_COUNT];
+#if defined(PMW3360_micros)
+static uint32_t PMW3360_holdoffStart[PMW3360_SENSOR_COUNT];
+#endif
+
 /*
- * Read register from PMW3360 sensor.
+ * Add to the delay owed before the next transaction with the selected sensor.
+ */
+static void PMW3360_defer(uint32_t us)
+{
+#if defined(PMW3360_micros)
+    // Time starts counting from the first deferral after the last settle
+    if (PMW3360_holdoff[PMW3360_sensor] == 0) {
+        PMW3360_holdoffStart[PMW3360_sensor] = PMW3360_micros();
+    }
+#endif
+    PMW3360_holdoff[PMW3360_sensor] += us;
+
+    return;
+}
+
+/*
+ * Wait out the delay owed to the selected sensor.
+ *
+ * When the port provides PMW3360_micros, time spent by the caller since
+ * the last transaction counts towards the delay. Without it only the waits
+ * themselves are counted, towards every sensor's delay.
+ */
+static void PMW3360_settle(void)
+{
+    uint32_t us = PMW3360_holdoff[PMW3360_sensor];
+#if !defined(PMW3360_micros) && PMW3360_SENSOR_COUNT > 1
+    uint8_t i;
+#endif
+
+#if defined(PMW3360_micros)
+    // The first tick may have come right after the deferral, only whole microseconds count
+    uint32_t elapsed = PMW3360_micros() - PMW3360_holdoffStart[PMW3360_sensor];
+    elapsed = elapsed ? elapsed - 1 : 0;
+    us = elapsed < us ? us - elapsed : 0;
+#endif
+    PMW3360_delayVariable(us);
+    PMW3360_holdoff[PMW3360_sensor] = 0;
+
+#if !defined(PMW3360_micros) && PMW3360_SENSOR_COUNT > 1
+    // The other sensors waited just as long
+    for (i = 0; i < PMW3360_SENSOR_COUNT; i++) {
+        PMW3360_holdoff[i] = PMW3360_holdoff[i] > us ? PMW3360_holdoff[i] - us : 0;
+    }
+#endif
+
+    return;
+}
+
+/*
+ * Find the shadow cache slot of a register, returns PMW3360_CACHE_SIZE if not cached.
+ */
+static uint8_t PMW3360_cacheSlot(uint8_t address)
+{
+    uint8_t i;
+
+    for (i = 0; i < PMW3360_CACHE_SIZE; i++) {
+        if (PMW3360_cachedRegisters[i] == address) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/*
+ * Record a register value in the shadow cache of the selected sensor.
  */
-static uint8_t PMW3360_readRegister(uint8_t address)
+static void PMW3360_cacheStore(uint8_t address, uint8_t data)
 {
-    uint8_t data;
+    uint8_t slot = PMW3360_cacheSlot(address);
 
-    // Begin SPI transmission
-    PMW3360_SPI_begin();
+    if (slot < PMW3360_CACHE_SIZE) {
+        PMW3360_cache[PMW3360_sensor][slot] = data;
+        PMW3360_cacheValid[PMW3360_sensor] |= (uint32_t)1 << slot;
+    }
 
-    // Write register address, delay 160us (tSRAD) and read register data
-    PMW3360_SPI_readWrite(address & 0x7f);
-    PMW3360_delayMicroseconds(160);
-    data = PMW3360_SPI_readWrite(0);
+    return;
+}
 
-    // End SPI transmission and delay 20us (tSRR)
-    PMW3360_SPI_end();
-    PMW3360_delayMicroseconds(20);
+/*
+ * Drop a register from the shadow cache of the selected sensor, its value on the sensor is unknown.
+ */
+static void PMW3360_cacheForget(uint8_t address)
+{
+    uint8_t slot = PMW3360_cacheSlot(address);
+
+    if (slot < PMW3360_CACHE_SIZE) {
+        PMW3360_cacheValid[PMW3360_sensor] &= ~((uint32_t)1 << slot);
+    }
+
+    return;
+}
+
+/*
+ * Read register from PMW3360 sensor.
+ */
+uint8_t PMW3360_readRegister(uint8_t address)
+{
+    uint8_t data = 0;
+    uint8_t command = address & 0x7f;
+    bool ok;
+    PMW3360_transfer xfer[2] = {
+        // Write register address and delay 160us (tSRAD)
+        { &command, NULL, 1, 160, 0 },
+        // Read register data
+        { NULL, &data, 1, 0, 0 },
+    };
+
+    // Wait for the previous transaction's tSWR or tSRR
+    PMW3360_settle();
+
+    // Run the SPI transaction, the 20us tSRR is owed before the next one
+    ok = PMW3360_SPI_transfer(xfer, 2);
+    PMW3360_defer(20);
+
+    // A failed transfer reads as zero and is not cached
+    if (!ok) {
+        return 0;
+    }
+    PMW3360_cacheStore(address, data);
 
     return data;
 }
@@ -53,36 +226,83 @@ static uint8_t PMW3360_readRegister(uint8_t address)
 /*
  * Write register to PMW3360 sensor.
  */
-static void PMW3360_writeRegister(uint8_t address, uint8_t data)
+void PMW3360_writeRegister(uint8_t address, uint8_t data)
 {
-    // Begin SPI transmission
-    PMW3360_SPI_begin();
-
     // Write register address with MSB set indicating it's a write and send data
-    PMW3360_SPI_readWrite(address | 0x80);
-    PMW3360_SPI_readWrite(data);
+    uint8_t command[2] = { address | 0x80, data };
+    PMW3360_transfer xfer = { command, NULL, 2, 35, 0 };
 
-    // End SPI transmission and delay 180us (tSWR)
-    PMW3360_SPI_end();
-    PMW3360_delayMicroseconds(180);
+    // Wait for the previous transaction's tSWW or tSRW
+    PMW3360_settle();
+
+    // Run the SPI transaction holding chip select 35us (tSCLK-NCS for writes),
+    // the rest of the 180us tSWW/tSWR is owed before the next one
+    if (PMW3360_SPI_transfer(&xfer, 1)) {
+        PMW3360_cacheStore(address, data);
+    }
+    else {
+        PMW3360_cacheForget(address);
+    }
+    PMW3360_defer(145);
 
     return;
 }
 
 /*
- * Initialize the PMW3360 sensor.
+ * Write a table of registers, skipping values already in the shadow cache.
  */
-bool PMW3360_init(void)
+bool PMW3360_writeRegisters(const PMW3360_regValue *table, uint8_t count, uint8_t flags)
 {
-    uint16_t i;
-    uint16_t id;
+    uint8_t i, slot;
+    uint32_t written = 0;
+    bool result = true;
+
+    if (count > PMW3360_WRITE_MAX) {
+        return false;
+    }
+
+    for (i = 0; i < count; i++) {
+        // Skip the write when the sensor is known to hold the value already
+        slot = PMW3360_cacheSlot(table[i].address);
+        if ((flags & PMW3360_WRITE_FORCE) || slot >= PMW3360_CACHE_SIZE ||
+            (PMW3360_cacheValid[PMW3360_sensor] & ((uint32_t)1 << slot)) == 0 ||
+            PMW3360_cache[PMW3360_sensor][slot] != table[i].value) {
+            PMW3360_writeRegister(table[i].address, table[i].value);
+            written |= (uint32_t)1 << i;
+        }
+    }
+
+    // Read back every register that was written
+    if (flags & PMW3360_WRITE_VERIFY) {
+        for (i = 0; i < count; i++) {
+            if ((written & ((uint32_t)1 << i)) && PMW3360_readRegister(table[i].address) != table[i].value) {
+                result = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Configure the serial interface and hard reset the sensor.
+ */
+static bool PMW3360_reset(void)
+{
+    uint8_t i;
 
     // Configure serial interface
-    PMW3360_SPI_init();
+    if (!PMW3360_SPI_init()) {
+        return false;
+    }
 
-    // Perform a hard reset and wait for sensor to reboot
+    // Perform a hard reset and wait for sensor to reboot, this returns every register to its power-up value
+    PMW3360_cacheValid[PMW3360_sensor] = 0;
     PMW3360_writeRegister(PMW3360_REG_POWER_UP_RESET, 0x5a);
-    PMW3360_delayMicroseconds(50);
+    PMW3360_defer(50);
+    for (i = 0; i < sizeof(PMW3360_resetValues)/sizeof(PMW3360_resetValues[0]); i++) {
+        PMW3360_cacheStore(PMW3360_resetValues[i].address, PMW3360_resetValues[i].value);
+    }
 
     // read registers 0x02-0x06
     PMW3360_readRegister(PMW3360_REG_MOTION);
@@ -91,43 +311,57 @@ bool PMW3360_init(void)
     PMW3360_readRegister(PMW3360_REG_DELTA_Y_L);
     PMW3360_readRegister(PMW3360_REG_DELTA_Y_H);
 
+    return true;
+}
+
+/*
+ * Upload the SROM firmware and verify it is running.
+ */
+static bool PMW3360_upload(void)
+{
+    static const uint8_t loadBurst = PMW3360_REG_SROM_LOAD_BURST | 0x80;
+    const PMW3360_transfer upload[2] = {
+        // Write to register to begin load burst transfer and delay 15us
+        { &loadBurst, NULL, 1, 15, 0 },
+        // Write all bytes of the firmware image, delaying 15us after each
+        { PMW3360_firmware, NULL, PMW3360_FIRMWARE_SIZE, 15, PMW3360_XFER_BYTE_DELAY },
+    };
+
     // Write 0 to Rest_En bit of Config2 register to disable rest mode
     PMW3360_writeRegister(PMW3360_REG_CONFIG2, 0x00);
 
     // Write 0x1d in SROM_enable register to initialize and delay 10ms
     PMW3360_writeRegister(PMW3360_REG_SROM_ENABLE, 0x1d);
-    PMW3360_delayMicroseconds(10000);
+    PMW3360_defer(10000);
 
     // Write 0x18 to SROM_enable register again to start SROM download and delay 120us
     PMW3360_writeRegister(PMW3360_REG_SROM_ENABLE, 0x18);
-    PMW3360_delayMicroseconds(120);
-
-    // Begin SPI transmission for load burst transfer
-    PMW3360_SPI_begin();
+    PMW3360_defer(120);
+    PMW3360_settle();
 
-    // Write to register to begin load burst transfer and delay 15us
-    PMW3360_SPI_readWrite(PMW3360_REG_SROM_LOAD_BURST | 0x80);
-    PMW3360_delayMicroseconds(15);
-
-    // Write all bytes of the firmware image
-    for (i = 0; i < sizeof(PMW3360_firmware); i++) {
-        // Write data byte and delay 15us
-        PMW3360_SPI_readWrite(PMW3360_firmware[i]);
-        PMW3360_delayMicroseconds(15);
-    }
-
-    // End SPI transmission to signal end of burst load and delay 200us
-    PMW3360_SPI_end();
-    PMW3360_delayMicroseconds(200);
+    // Upload the firmware in one load burst, ending the transaction signals the end of the load
+    PMW3360_SPI_transfer(upload, 2);
+    PMW3360_defer(200);
 
     // Read the SROM_ID register to verify the ID before any other register reads or writes
-    id = PMW3360_readRegister(PMW3360_REG_SROM_ID);
-    if (id == 0x04) {
-        // Firmware load successful, write 0x00 to Config2 register for wired mouse design
-        PMW3360_writeRegister(PMW3360_REG_CONFIG2, 0x00);
+    return PMW3360_readRegister(PMW3360_REG_SROM_ID) == 0x04;
+}
 
+/*
+ * Initialize the PMW3360 sensor.
+ */
+bool PMW3360_init(void)
+{
+    static const PMW3360_regValue defaults[] = {
+        // Write 0x00 to Config2 register for wired mouse design
+        { PMW3360_REG_CONFIG2, 0x00 },
         // Set DPI to 800 by default
-        PMW3360_writeRegister(PMW3360_REG_CONFIG1, 0x07);
+        { PMW3360_REG_CONFIG1, 0x07 },
+    };
+
+    if (PMW3360_reset() && PMW3360_upload()) {
+        // Firmware load successful, apply the default configuration
+        PMW3360_writeRegisters(defaults, sizeof(defaults)/sizeof(defaults[0]), PMW3360_WRITE_FORCE);
 
         // Initialization successful
         return true;
@@ -145,53 +379,272 @@ void PMW3360_shutdown(void)
 {
     // Write 0xB6 to Shutdown register to start shutdown
     PMW3360_writeRegister(PMW3360_REG_SHUTDOWN, 0xb6);
+    PMW3360_settle();
 
     // Shutdown serial interface
-    PMW3360_SPI_end();
     PMW3360_SPI_shutdown();
 
     return;
 }
 
 /*
- * Read one frame of motion data.
+ * Save the active configuration and shut the sensor down.
+ */
+void PMW3360_suspend(PMW3360_snapshot *snapshot)
+{
+    uint8_t i;
+
+    // The shadow cache holds every configuration register written or read since init
+    for (i = 0; i < PMW3360_CACHE_SIZE; i++) {
+        snapshot->values[i] = PMW3360_cache[PMW3360_sensor][i];
+    }
+    snapshot->valid = PMW3360_cacheValid[PMW3360_sensor];
+
+    PMW3360_shutdown();
+
+    return;
+}
+
+/*
+ * Wake the sensor, restore a saved configuration and read the first sample.
  */
-void PMW3360_read(PMW3360_data *data)
+bool PMW3360_resume(const PMW3360_snapshot *snapshot, PMW3360_data *data, uint32_t *latency)
 {
-    uint16_t i;
-    uint8_t burstBuffer[12];
+    PMW3360_regValue table[PMW3360_CACHE_SIZE];
+    uint8_t i, count = 0;
+#if defined(PMW3360_micros)
+    uint32_t start = PMW3360_micros();
+#endif
+
+    // Wake with a hard reset, then only upload the firmware if the sensor lost it
+    if (!PMW3360_reset()) {
+        return false;
+    }
+    if (PMW3360_readRegister(PMW3360_REG_SROM_ID) != 0x04 && !PMW3360_upload()) {
+        return false;
+    }
+
+    // Replay the saved configuration, Config2 is last in the table so rest mode starts fully configured,
+    // registers the reset left at the saved value are skipped
+    for (i = 0; i < PMW3360_CACHE_SIZE; i++) {
+        if (snapshot->valid & ((uint32_t)1 << i)) {
+            table[count].address = PMW3360_cachedRegisters[i];
+            table[count].value = snapshot->values[i];
+            count++;
+        }
+    }
+    PMW3360_writeRegisters(table, count, 0);
+
+    // The first burst after the configuration is the first valid sample
+    PMW3360_read(data);
+#if defined(PMW3360_micros)
+    *latency = PMW3360_micros() - start;
+#else
+    *latency = PMW3360_LATENCY_UNKNOWN;
+#endif
+
+    return true;
+}
+
+#if PMW3360_CHECK_BURST
+// Counters of burst integrity checks
+static PMW3360_burstStats PMW3360_burstCounters;
+
+/*
+ * Check a motion burst for bus faults and implausible values.
+ */
+static bool PMW3360_checkBurst(const uint8_t *burstBuffer, uint8_t length)
+{
+    uint8_t i;
+    uint8_t all = 0xff;
+    uint8_t any = 0x00;
+
+    // A floating or shorted MISO line reads as all ones or all zeros
+    for (i = 0; i < length; i++) {
+        all &= burstBuffer[i];
+        any |= burstBuffer[i];
+    }
+    if (all == 0xff || any == 0x00) {
+        return false;
+    }
+
+    // Reserved bits of the Motion register always read as zero
+    if (burstBuffer[0] & PMW3360_MOTION_RESERVED) {
+        return false;
+    }
+
+    // SQUAL, raw data range and shutter must be plausible
+    if (length == 12 && (burstBuffer[6] > PMW3360_SQUAL_MAX || burstBuffer[9] > burstBuffer[8] ||
+                         (burstBuffer[10] | burstBuffer[11]) == 0)) {
+        return false;
+    }
+
+    return true;
+}
 
-    // Begin burst transfer by writing to the Motion_Burst register
-    PMW3360_writeRegister(PMW3360_REG_MOTION_BURST, 0);
+/*
+ * Get the burst integrity check counters.
+ */
+void PMW3360_getBurstStats(PMW3360_burstStats *stats)
+{
+    *stats = PMW3360_burstCounters;
 
-    // Begin SPI transmission for burst mode and delay 35us (tSRAD_MOTBR)
-    PMW3360_SPI_begin();
-    PMW3360_SPI_readWrite(PMW3360_REG_MOTION_BURST);
-    PMW3360_delayMicroseconds(35);
+    return;
+}
+#endif
 
-    // Read twelve bytes into the buffer with no delay
-    for (i = 0; i < sizeof(burstBuffer); i++) {
-        burstBuffer[i] = PMW3360_SPI_readWrite(0);
+/*
+ * Read and decode a motion burst, stopping after length bytes.
+ *
+ * With latch set the Motion_Burst write is part of the same transaction,
+ * otherwise the motion must already be latched by PMW3360_startBurst.
+ */
+static bool PMW3360_readBurst(PMW3360_data *data, uint8_t length, bool latch)
+{
+    static const uint8_t command[3] = { PMW3360_REG_MOTION_BURST | 0x80, 0, PMW3360_REG_MOTION_BURST };
+    uint8_t burstBuffer[PMW3360_BURST_LENGTH];
+    const PMW3360_transfer xfer[3] = {
+        // Write any value to the Motion_Burst register and delay 180us (tSWR) before releasing chip select,
+        // which also covers the 35us write hold (tSCLK-NCS)
+        { &command[0], NULL, 2, 180, PMW3360_XFER_CS_CHANGE },
+        // Begin burst mode and delay 35us (tSRAD_MOTBR)
+        { &command[2], NULL, 1, 35, 0 },
+        // Read the requested number of bytes into the buffer with no delay
+        { NULL, burstBuffer, length, 0, 0 },
+    };
+    bool ok;
+#if PMW3360_CHECK_BURST
+    uint8_t retries = PMW3360_CHECK_RETRIES;
+#endif
+
+    // Run the burst as one SPI transaction, the 1us tBEXIT is owed before the next one
+    PMW3360_settle();
+    if (latch) {
+        ok = PMW3360_SPI_transfer(xfer, 3);
+    }
+    else {
+        ok = PMW3360_SPI_transfer(&xfer[1], 2);
     }
+    PMW3360_defer(1);
+
+#if PMW3360_CHECK_BURST
+    // Re-read suspicious bursts within the retry budget, each retry latches fresh motion
+    PMW3360_burstCounters.checked++;
+    while (ok && !PMW3360_checkBurst(burstBuffer, length)) {
+        PMW3360_burstCounters.rejected++;
+        if (retries == 0) {
+            // Report no motion rather than a corrupted displacement
+            PMW3360_burstCounters.failed++;
+            data->motion = false;
+            data->dx = 0;
+            data->dy = 0;
+            return true;
+        }
+        retries--;
+        PMW3360_burstCounters.retried++;
+        PMW3360_settle();
+        ok = PMW3360_SPI_transfer(xfer, 3);
+        PMW3360_defer(1);
+    }
+#endif
 
-    // Terminate burst transfer and delay 1us (tBEXIT)
-    PMW3360_SPI_end();
-    PMW3360_delayMicroseconds(1);
+    // The bus failed, the buffer holds no valid data
+    if (!ok) {
+        data->motion = false;
+        data->dx = 0;
+        data->dy = 0;
+        return false;
+    }
 
     // Calculate motion data
     data->motion = (burstBuffer[0] & 0x80) != 0;
     data->surface = (burstBuffer[0] & 0x08) == 0;
     data->dx = (int16_t)(((uint16_t)burstBuffer[3] << 8) + (uint16_t)burstBuffer[2]);
     data->dy = (int16_t)(((uint16_t)burstBuffer[5] << 8) + (uint16_t)burstBuffer[4]);
-    data->SQUAL = burstBuffer[6];
-    data->rawDataSum = burstBuffer[7];
-    data->maxRawData = burstBuffer[8];
-    data->minRawData = burstBuffer[9];
-    data->shutter = ((uint16_t)burstBuffer[11] << 8) + (uint16_t)burstBuffer[10];
+
+#if PMW3360_ENABLE_DIAGNOSTICS
+    // Calculate surface data when the full burst was read
+    if (length == sizeof(burstBuffer)) {
+        data->SQUAL = burstBuffer[6];
+        data->rawDataSum = burstBuffer[7];
+        data->maxRawData = burstBuffer[8];
+        data->minRawData = burstBuffer[9];
+        data->shutter = ((uint16_t)burstBuffer[11] << 8) + (uint16_t)burstBuffer[10];
+    }
+#endif
+
+    return true;
+}
+
+/*
+ * Read one frame of motion data.
+ */
+bool PMW3360_read(PMW3360_data *data)
+{
+    return PMW3360_readBurst(data, PMW3360_BURST_LENGTH, true);
+}
+
+/*
+ * Read one frame of motion data without the surface fields.
+ */
+bool PMW3360_readMotion(PMW3360_data *data)
+{
+    // Read only the motion, observation and delta bytes
+    return PMW3360_readBurst(data, 6, true);
+}
+
+#if PMW3360_SENSOR_COUNT > 1
+/*
+ * Latch motion data by writing to the Motion_Burst register, tSWR is owed afterwards.
+ */
+static void PMW3360_startBurst(void)
+{
+    // Write any value to the Motion_Burst register
+    static const uint8_t command[2] = { PMW3360_REG_MOTION_BURST | 0x80, 0 };
+    const PMW3360_transfer xfer = { command, NULL, 2, 35, 0 };
+
+    // Hold chip select 35us after the write (tSCLK-NCS), the rest of tSWR is owed per sensor
+    PMW3360_settle();
+    PMW3360_SPI_transfer(&xfer, 1);
+    PMW3360_defer(145);
 
     return;
 }
 
+/*
+ * Select the sensor addressed by the following calls.
+ */
+void PMW3360_select(uint8_t sensor)
+{
+    PMW3360_sensor = sensor;
+    PMW3360_SPI_select(sensor);
+
+    return;
+}
+
+/*
+ * Read one frame of motion data from both sensors.
+ */
+bool PMW3360_readPair(PMW3360_data *first, PMW3360_data *second)
+{
+    bool ok;
+
+    // Latch motion on both sensors back to back, tSWR only applies per sensor
+    PMW3360_select(0);
+    PMW3360_startBurst();
+    PMW3360_select(1);
+    PMW3360_startBurst();
+
+    // Read the latched burst data from each sensor. Sensor 0 started its tSWR first,
+    // settling sensor 1 and its burst count towards it
+    ok = PMW3360_readBurst(second, PMW3360_BURST_LENGTH, false);
+    PMW3360_select(0);
+    ok = PMW3360_readBurst(first, PMW3360_BURST_LENGTH, false) && ok;
+
+    return ok;
+}
+#endif
+
 /*
  * Set the DPI level of the PMW3360 sensor.
  */
@@ -209,6 +662,7 @@ void PMW3360_setDPI(uint16_t dpi)
     PMW3360_writeRegister(PMW3360_REG_CONFIG1, val);
 }
 
+#if PMW3360_ENABLE_GETDPI
 /*
  * Get the DPI level of the PMW3360 sensor.
  */
@@ -223,3 +677,48 @@ uint16_t PMW3360_getDPI()
     val = (val + 1)*100;
     return val;
 }
+#endif
+
+/*
+ * Enable or disable the hardware angle snapping.
+ */
+void PMW3360_setAngleSnap(bool enable)
+{
+    PMW3360_writeRegister(PMW3360_REG_ANGLE_SNAP, enable ? PMW3360_ANGLE_SNAP_EN : 0x00);
+}
+
+#if PMW3360_ENABLE_FRAME_CAPTURE
+/*
+ * Capture one raw image frame.
+ */
+void PMW3360_captureFrame(uint8_t *frame)
+{
+    static const uint8_t command = PMW3360_REG_RAW_DATA_BURST;
+    const PMW3360_transfer xfer[2] = {
+        // Begin raw data burst and delay 160us (tSRAD)
+        { &command, NULL, 1, 160, 0 },
+        // Read every pixel, delaying 15us after each
+        { NULL, frame, PMW3360_FRAME_SIZE, 15, PMW3360_XFER_BYTE_DELAY },
+    };
+    uint8_t config2;
+
+    // Disable rest mode for the capture
+    config2 = PMW3360_readRegister(PMW3360_REG_CONFIG2);
+    PMW3360_writeRegister(PMW3360_REG_CONFIG2, config2 & ~PMW3360_CONFIG2_REST_EN);
+
+    // Write 0x83 then 0xc5 to Frame_Capture to start the capture and delay 20ms
+    PMW3360_writeRegister(PMW3360_REG_FRAME_CAPTURE, 0x83);
+    PMW3360_writeRegister(PMW3360_REG_FRAME_CAPTURE, 0xc5);
+    PMW3360_defer(20000);
+
+    // Read the frame in one burst, the 1us tBEXIT is owed before the next transaction
+    PMW3360_settle();
+    PMW3360_SPI_transfer(xfer, 2);
+    PMW3360_defer(1);
+
+    // Restore rest mode
+    PMW3360_writeRegister(PMW3360_REG_CONFIG2, config2);
+
+    return;
+}
+#endif
@@ -27,6 +27,46 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of sensors sharing the SPI bus, each with its own chip select
+#ifndef PMW3360_SENSOR_COUNT
+#define PMW3360_SENSOR_COUNT                        1
+#endif
+
+// Validate motion bursts and re-read suspicious ones, costs a few cycles per sample.
+// A 6-byte burst (diagnostics off) is only checked for stuck MISO and the Motion reserved bits
+#ifndef PMW3360_CHECK_BURST
+#define PMW3360_CHECK_BURST                         0
+#endif
+
+// Re-reads allowed per sample when a burst fails validation
+#ifndef PMW3360_CHECK_RETRIES
+#define PMW3360_CHECK_RETRIES                       2
+#endif
+
+// Size optimized build, defaults the optional features below to off
+#ifndef PMW3360_SIZE_OPTIMIZED
+#define PMW3360_SIZE_OPTIMIZED                      0
+#endif
+
+// Include PMW3360_getDPI
+#ifndef PMW3360_ENABLE_GETDPI
+#define PMW3360_ENABLE_GETDPI                       (!PMW3360_SIZE_OPTIMIZED)
+#endif
+
+// Include the surface fields in PMW3360_data, without them PMW3360_read reads a 6-byte burst
+#ifndef PMW3360_ENABLE_DIAGNOSTICS
+#define PMW3360_ENABLE_DIAGNOSTICS                  (!PMW3360_SIZE_OPTIMIZED)
+#endif
+
+// Include PMW3360_captureFrame
+#ifndef PMW3360_ENABLE_FRAME_CAPTURE
+#define PMW3360_ENABLE_FRAME_CAPTURE                (!PMW3360_SIZE_OPTIMIZED)
+#endif
+
 // PMW3360 register definitions
 #define PMW3360_REG_PRODUCT_ID                      0x00
 #define PMW3360_REG_REVISION_ID                     0x01
@@ -78,6 +118,22 @@
 #define PMW3360_REG_RAW_DATA_BURST                  0x64
 #define PMW3360_REG_LIFTCUTOFF_TUNE2                0x65
 
+// Rest_En bit of the Config2 register
+#define PMW3360_CONFIG2_REST_EN                     0x20
+
+// Enable bit of the Angle_Snap register
+#define PMW3360_ANGLE_SNAP_EN                       0x80
+
+// Raw data frame dimensions
+#define PMW3360_FRAME_WIDTH                         36
+#define PMW3360_FRAME_SIZE                          (PMW3360_FRAME_WIDTH*PMW3360_FRAME_WIDTH)
+
+// Reserved bits of the Motion register, read as zero
+#define PMW3360_MOTION_RESERVED                     0x70
+
+// Largest SQUAL value the sensor reports
+#define PMW3360_SQUAL_MAX                           0x80
+
 /**
  * @brief Data structure used to read burst data from sensor
  */
@@ -87,17 +143,65 @@ typedef struct PMW3360_data
     bool surface;           /**< True when a chip is on a surface */
     int16_t dx;             /**< Displacement on x directions */
     int16_t dy;             /**< Displacement on y directions */
+#if PMW3360_ENABLE_DIAGNOSTICS
     uint8_t SQUAL;          /**< Surface Quality register */
     uint8_t rawDataSum;     /**< Upper byte of 18-bit counter which sums all raw data */
     uint8_t maxRawData;     /**< Max raw data value in current frame */
     uint8_t minRawData;     /**< Min raw data value in current frame */
     uint16_t shutter;       /**< Clock cycles of the internal oscillator */
+#endif
 } PMW3360_data;
 
+// Flags for PMW3360_writeRegisters
+#define PMW3360_WRITE_VERIFY                        0x01    /**< Read back written registers */
+#define PMW3360_WRITE_FORCE                         0x02    /**< Write even if the cached value matches */
+
+// Maximum number of entries in a PMW3360_writeRegisters table
+#define PMW3360_WRITE_MAX                           32
+
+/**
+ * @brief Burst integrity check counters
+ *
+ * Every burst is checked for an all-ones or all-zeros read and for set reserved
+ * bits in Motion. The SQUAL, raw data range and shutter checks need the 12-byte
+ * burst, so a 6-byte burst with garbled motion bytes can still pass.
+ */
+typedef struct PMW3360_burstStats
+{
+    uint32_t checked;       /**< Bursts checked */
+    uint32_t rejected;      /**< Bursts that failed validation, including retries */
+    uint32_t retried;       /**< Bursts read again after failing validation */
+    uint32_t failed;        /**< Samples reported as no motion after the retry budget ran out */
+} PMW3360_burstStats;
+
+/**
+ * @brief Register address and value pair used by PMW3360_writeRegisters
+ */
+typedef struct PMW3360_regValue
+{
+    uint8_t address;        /**< Register address */
+    uint8_t value;          /**< Value to write */
+} PMW3360_regValue;
+
+// Number of configuration registers held in a PMW3360_snapshot
+#define PMW3360_SNAPSHOT_SIZE                       18
+
+// Latency reported by PMW3360_resume when the port has no microsecond clock
+#define PMW3360_LATENCY_UNKNOWN                     0xffffffff
+
+/**
+ * @brief Configuration saved by PMW3360_suspend and replayed by PMW3360_resume
+ */
+typedef struct PMW3360_snapshot
+{
+    uint8_t values[PMW3360_SNAPSHOT_SIZE];  /**< Configuration register values */
+    uint32_t valid;                         /**< Bit set for each value that was known */
+} PMW3360_snapshot;
+
 /**
  * @brief Initialize the PMW3360 sensor.
  *
- * @return none
+ * @return False if the serial interface could not be opened or the firmware did not start
  */
 bool PMW3360_init();
 
@@ -108,13 +212,117 @@ bool PMW3360_init();
  */
 void PMW3360_shutdown();
 
+/**
+ * @brief Save the active configuration and shut the sensor down.
+ *
+ * @param snapshot Pointer to PMW3360_snapshot structure to save into.
+ * @return none
+ */
+void PMW3360_suspend(PMW3360_snapshot *snapshot);
+
+/**
+ * @brief Wake the sensor and restore the configuration saved by PMW3360_suspend.
+ *
+ * The firmware is only uploaded again if the sensor did not keep it, and
+ * only registers that differ from their power-up value are written.
+ *
+ * @param snapshot Configuration to restore.
+ * @param data Pointer to PMW3360_data structure to read the first sample into.
+ * @param latency Set to the wake to first sample time in microseconds, or PMW3360_LATENCY_UNKNOWN.
+ * @return False if the serial interface could not be opened or the firmware upload failed
+ */
+bool PMW3360_resume(const PMW3360_snapshot *snapshot, PMW3360_data *data, uint32_t *latency);
+
 /**
  * @brief Read one frame of motion data.
  *
  * @param data Pointer to PMW3360_data structure to read data into.
+ * @return False if the bus reported an error, data then holds no motion
+ */
+bool PMW3360_read(PMW3360_data *data);
+
+/**
+ * @brief Read one frame of motion data using a shortened burst.
+ *
+ * Only motion, surface, dx and dy are updated, the remaining fields keep
+ * their previous values. Saves six bytes of bus time per sample.
+ *
+ * @param data Pointer to PMW3360_data structure to read data into.
+ * @return False if the bus reported an error, data then holds no motion
+ */
+bool PMW3360_readMotion(PMW3360_data *data);
+
+#if PMW3360_SENSOR_COUNT > 1
+/**
+ * @brief Select the sensor addressed by the following calls.
+ *
+ * Each sensor is initialized separately by selecting it and calling PMW3360_init.
+ *
+ * @param sensor Index of the sensor, 0 or 1.
  * @return none
  */
-void PMW3360_read(PMW3360_data *data);
+void PMW3360_select(uint8_t sensor);
+
+/**
+ * @brief Read one frame of motion data from both sensors.
+ *
+ * Motion is latched on both sensors with back to back register writes, so
+ * the skew between the two samples is bounded by a single register write
+ * rather than a full burst read. Sensor 0 is selected on return.
+ *
+ * @param first Pointer to PMW3360_data structure to read sensor 0 data into.
+ * @param second Pointer to PMW3360_data structure to read sensor 1 data into.
+ * @return False if the bus reported an error for either sensor
+ */
+bool PMW3360_readPair(PMW3360_data *first, PMW3360_data *second);
+#endif
+
+#if PMW3360_CHECK_BURST
+/**
+ * @brief Get the burst integrity check counters.
+ *
+ * @param stats Pointer to PMW3360_burstStats structure to copy into.
+ * @return none
+ */
+void PMW3360_getBurstStats(PMW3360_burstStats *stats);
+#endif
+
+/**
+ * @brief Read a register of the PMW3360 sensor.
+ *
+ * Includes the tSRAD delay, tSRR is paid before the next transaction with the sensor.
+ *
+ * @param address Register address.
+ * @return Register value
+ */
+uint8_t PMW3360_readRegister(uint8_t address);
+
+/**
+ * @brief Write a register of the PMW3360 sensor.
+ *
+ * The tSWW/tSWR delay is paid before the next transaction with the sensor.
+ *
+ * @param address Register address.
+ * @param data Value to write.
+ * @return none
+ */
+void PMW3360_writeRegister(uint8_t address, uint8_t data);
+
+/**
+ * @brief Write a table of registers in one call.
+ *
+ * Configuration registers are mirrored in a shadow cache, writes of values
+ * the sensor already holds are skipped. The cache starts out with the
+ * power-up values of the angle, lift and rest registers, so the first
+ * table after PMW3360_init only writes what differs from them. Only the tSWW spacing is kept
+ * between writes, and the final tSWR is paid by the next transaction.
+ *
+ * @param table Register and value pairs, written in order.
+ * @param count Number of entries in the table, at most PMW3360_WRITE_MAX.
+ * @param flags PMW3360_WRITE_VERIFY and/or PMW3360_WRITE_FORCE.
+ * @return False if the table is too long or a read back value differs
+ */
+bool PMW3360_writeRegisters(const PMW3360_regValue *table, uint8_t count, uint8_t flags);
 
 /**
  * @brief Set the DPI level of the PMW3360 sensor.
@@ -124,11 +332,41 @@ void PMW3360_read(PMW3360_data *data);
  */
 void PMW3360_setDPI(uint16_t DPI);
 
+#if PMW3360_ENABLE_GETDPI
 /**
  * @brief Get the DPI level of the PMW3360 sensor.
  *
  * @return DPI level
  */
 uint16_t PMW3360_getDPI();
+#endif
+
+/**
+ * @brief Enable or disable the hardware angle snapping.
+ *
+ * The sensor snaps motion within a few degrees of an axis onto that axis.
+ * For a hard axis lock with hysteresis use PMW3360_snap.c instead.
+ *
+ * @param enable True to enable angle snapping.
+ * @return none
+ */
+void PMW3360_setAngleSnap(bool enable);
+
+#if PMW3360_ENABLE_FRAME_CAPTURE
+/**
+ * @brief Capture one raw image frame.
+ *
+ * Rest mode is disabled during the capture and restored afterwards. The
+ * capture takes about 40ms, no motion is reported in that time.
+ *
+ * @param frame Buffer of PMW3360_FRAME_SIZE bytes, row by row.
+ * @return none
+ */
+void PMW3360_captureFrame(uint8_t *frame);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif //PMW3360_H__
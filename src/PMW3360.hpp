@@ -0,0 +1,382 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_HPP__
+#define PMW3360_HPP__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "PMW3360.h"
+#include "PMW3360_firmware.h"
+
+#if defined(__PICO_SDK__)
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#elif defined(__MSP430FR5994__)
+#include <msp430.h>
+#endif
+
+namespace pmw3360 {
+
+/**
+ * @brief Default timing and burst configuration, in microseconds
+ *
+ * Derive from this and override members to change a value, everything is
+ * constexpr so the driver inlines with no run-time dispatch.
+ */
+struct DefaultConfig
+{
+    static constexpr uint16_t tSRAD = 160;          /**< Address to read data delay */
+    static constexpr uint16_t tSRR = 20;            /**< Read to next transaction delay */
+    static constexpr uint16_t tSWW = 180;           /**< Write to next transaction delay */
+    static constexpr uint16_t tSCLK_NCS_WRITE = 35; /**< Last clock of a write to chip select release */
+    static constexpr uint16_t tSRAD_MOTBR = 35;     /**< Motion burst address to data delay */
+    static constexpr uint16_t tBEXIT = 1;           /**< Burst exit delay */
+    static constexpr uint16_t tLOAD = 15;           /**< SROM load burst byte delay */
+    static constexpr uint8_t burstLength = PMW3360_ENABLE_DIAGNOSTICS ? 12 : 6;    /**< Motion burst bytes to read, 6 skips the surface fields */
+    static constexpr uint8_t defaultCPI = 0x07;     /**< Config1 value written by init, 800 DPI */
+};
+
+/**
+ * @brief PMW3360 driver specialized on a port policy
+ *
+ * The port policy provides static functions init(), shutdown(), begin(),
+ * end(), readWrite(uint8_t) and a delay<us>() template, see PicoPort and
+ * MSP430Port. Each specialization has its own bus and pins, so one binary
+ * can drive sensors on different buses.
+ *
+ * This is a smaller driver than PMW3360.c, not a drop-in equivalent. It
+ * keeps no shadow register cache, so every write goes to the bus, and it
+ * waits out each delay right after the transaction instead of deferring
+ * it to the next one, so caller time does not overlap register delays.
+ * Burst checks, bus error reporting, suspend/resume and readPair are only
+ * in the C driver.
+ */
+template <class Port, class Config = DefaultConfig>
+class PMW3360
+{
+    static_assert(Config::tSWW >= Config::tSCLK_NCS_WRITE, "tSWW includes the write hold");
+    static_assert(Config::burstLength == 6 || Config::burstLength == 12, "burstLength must be 6 or 12");
+    static_assert(PMW3360_ENABLE_DIAGNOSTICS || Config::burstLength == 6,
+                  "burstLength must be 6 when PMW3360_ENABLE_DIAGNOSTICS is off");
+
+public:
+    /**
+     * @brief Read a register of the PMW3360 sensor.
+     */
+    static uint8_t readRegister(uint8_t address)
+    {
+        uint8_t data;
+
+        // Write register address, delay tSRAD and read register data
+        Port::begin();
+        Port::readWrite(address & 0x7f);
+        Port::template delay<Config::tSRAD>();
+        data = Port::readWrite(0);
+
+        // End SPI transmission and delay tSRR
+        Port::end();
+        Port::template delay<Config::tSRR>();
+
+        return data;
+    }
+
+    /**
+     * @brief Write a register of the PMW3360 sensor.
+     */
+    static void writeRegister(uint8_t address, uint8_t data)
+    {
+        // Write register address with MSB set indicating it's a write and send data
+        Port::begin();
+        Port::readWrite(address | 0x80);
+        Port::readWrite(data);
+
+        // Hold chip select for tSCLK-NCS, end SPI transmission and delay the rest of tSWW
+        Port::template delay<Config::tSCLK_NCS_WRITE>();
+        Port::end();
+        Port::template delay<Config::tSWW - Config::tSCLK_NCS_WRITE>();
+    }
+
+    /**
+     * @brief Initialize the PMW3360 sensor.
+     *
+     * @return True if the firmware upload was verified
+     */
+    static bool init()
+    {
+        Port::init();
+
+        // Perform a hard reset and wait for sensor to reboot
+        writeRegister(PMW3360_REG_POWER_UP_RESET, 0x5a);
+        Port::template delay<50>();
+
+        // read registers 0x02-0x06
+        for (uint8_t address = PMW3360_REG_MOTION; address <= PMW3360_REG_DELTA_Y_H; address++) {
+            readRegister(address);
+        }
+
+        // Disable rest mode, then initialize the SROM and start the download
+        writeRegister(PMW3360_REG_CONFIG2, 0x00);
+        writeRegister(PMW3360_REG_SROM_ENABLE, 0x1d);
+        Port::template delay<10000>();
+        writeRegister(PMW3360_REG_SROM_ENABLE, 0x18);
+        Port::template delay<120>();
+
+        // Write all bytes of the firmware image in one load burst
+        Port::begin();
+        Port::readWrite(PMW3360_REG_SROM_LOAD_BURST | 0x80);
+        Port::template delay<Config::tLOAD>();
+        for (size_t i = 0; i < PMW3360_FIRMWARE_SIZE; i++) {
+            Port::readWrite(PMW3360_firmware[i]);
+            Port::template delay<Config::tLOAD>();
+        }
+        Port::end();
+        Port::template delay<200>();
+
+        // Verify the SROM_ID before any other register access
+        if (readRegister(PMW3360_REG_SROM_ID) != 0x04) {
+            return false;
+        }
+
+        // Configure for wired mouse design and the default resolution
+        writeRegister(PMW3360_REG_CONFIG2, 0x00);
+        writeRegister(PMW3360_REG_CONFIG1, Config::defaultCPI);
+
+        return true;
+    }
+
+    /**
+     * @brief Shutdown the PMW3360 sensor.
+     */
+    static void shutdown()
+    {
+        writeRegister(PMW3360_REG_SHUTDOWN, 0xb6);
+        Port::shutdown();
+    }
+
+    /**
+     * @brief Read one frame of motion data.
+     *
+     * With a burst length of 6 the surface fields are left untouched.
+     */
+    static void read(PMW3360_data &data)
+    {
+        uint8_t burstBuffer[Config::burstLength];
+
+        // Begin burst transfer by writing to the Motion_Burst register
+        writeRegister(PMW3360_REG_MOTION_BURST, 0);
+
+        // Begin burst mode, delay tSRAD_MOTBR and read the burst with no delay
+        Port::begin();
+        Port::readWrite(PMW3360_REG_MOTION_BURST);
+        Port::template delay<Config::tSRAD_MOTBR>();
+        for (uint8_t i = 0; i < Config::burstLength; i++) {
+            burstBuffer[i] = Port::readWrite(0);
+        }
+
+        // Terminate burst transfer and delay tBEXIT
+        Port::end();
+        Port::template delay<Config::tBEXIT>();
+
+        // Calculate motion data
+        data.motion = (burstBuffer[0] & 0x80) != 0;
+        data.surface = (burstBuffer[0] & 0x08) == 0;
+        data.dx = (int16_t)(((uint16_t)burstBuffer[3] << 8) + (uint16_t)burstBuffer[2]);
+        data.dy = (int16_t)(((uint16_t)burstBuffer[5] << 8) + (uint16_t)burstBuffer[4]);
+#if PMW3360_ENABLE_DIAGNOSTICS
+        if constexpr (Config::burstLength == 12) {
+            data.SQUAL = burstBuffer[6];
+            data.rawDataSum = burstBuffer[7];
+            data.maxRawData = burstBuffer[8];
+            data.minRawData = burstBuffer[9];
+            data.shutter = ((uint16_t)burstBuffer[11] << 8) + (uint16_t)burstBuffer[10];
+        }
+#endif
+    }
+
+    /**
+     * @brief Set the DPI level, rounds down to multiples of 100.
+     */
+    static void setDPI(uint16_t dpi)
+    {
+        int16_t val = (dpi/100) - 1;
+
+        // Check value is within range 0x00-0x77
+        val = val < 0 ? 0 : (val < 0x77 ? val : 0x77);
+        writeRegister(PMW3360_REG_CONFIG1, (uint8_t)val);
+    }
+
+    /**
+     * @brief Get the DPI level.
+     */
+    static uint16_t getDPI()
+    {
+        return (uint16_t)((readRegister(PMW3360_REG_CONFIG1) + 1)*100);
+    }
+
+    /**
+     * @brief Enable or disable the hardware angle snapping.
+     */
+    static void setAngleSnap(bool enable)
+    {
+        writeRegister(PMW3360_REG_ANGLE_SNAP, enable ? PMW3360_ANGLE_SNAP_EN : 0x00);
+    }
+};
+
+#if defined(__PICO_SDK__)
+/**
+ * @brief Raspberry Pi Pico port policy
+ *
+ * @tparam Bus SPI instance, 0 or 1.
+ * @tparam SCK, MOSI, MISO, CS GPIO numbers.
+ * @tparam Baudrate SPI clock in Hz.
+ */
+template <unsigned Bus, unsigned SCK, unsigned MOSI, unsigned MISO, unsigned CS, unsigned Baudrate = 1000000>
+struct PicoPort
+{
+    static spi_inst_t *spi()
+    {
+        return Bus ? spi1 : spi0;
+    }
+
+    static void init()
+    {
+        // Configure chip select pin
+        gpio_init(CS);
+        gpio_set_dir(CS, GPIO_OUT);
+        gpio_put(CS, 1);
+
+        // Configure SPI mode 3
+        spi_init(spi(), Baudrate);
+        spi_set_format(spi(), 8, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+        gpio_set_function(SCK, GPIO_FUNC_SPI);
+        gpio_set_function(MOSI, GPIO_FUNC_SPI);
+        gpio_set_function(MISO, GPIO_FUNC_SPI);
+
+        // Send dummy byte without chip selected to fix clock polarity
+        uint8_t data = 0;
+        spi_write_blocking(spi(), &data, 1);
+    }
+
+    static void shutdown()
+    {
+        spi_deinit(spi());
+    }
+
+    static void begin()
+    {
+        gpio_put(CS, 0);
+        delay<1>();
+    }
+
+    static void end()
+    {
+        delay<1>();
+        gpio_put(CS, 1);
+    }
+
+    static uint8_t readWrite(uint8_t data)
+    {
+        uint8_t result;
+
+        spi_write_read_blocking(spi(), &data, &result, 1);
+        return result;
+    }
+
+    template <uint32_t us>
+    static void delay()
+    {
+        sleep_us(us);
+    }
+};
+#endif
+
+#if defined(__MSP430FR5994__)
+/**
+ * @brief EXP430FR5994 port policy, USCI_B1 on P5.0-P5.2
+ *
+ * @tparam CS Chip select bit on port 5.
+ * @tparam MCLK CPU clock in Hz, SMCLK divided by 8 clocks the bus.
+ */
+template <uint8_t CS = BIT3, uint32_t MCLK = 8000000>
+struct MSP430Port
+{
+    static void init()
+    {
+        // Configure chip select pin
+        P5OUT |= CS;
+        P5DIR |= CS;
+
+        // Configure CLK, MOSI and MISO pins
+        P5SEL1 &= ~(BIT0 | BIT1 | BIT2);
+        P5SEL0 |= (BIT0 | BIT1 | BIT2);
+
+        // Configure USCI_B1 for SPI operation (3-pin, 8-bit, MSB)
+        UCB1CTLW0 = UCSWRST;
+        UCB1CTLW0 |= UCMST | UCSYNC | UCCKPL | UCMSB;
+        UCB1CTLW0 |= UCSSEL__SMCLK;
+        UCB1BRW = 0x08;
+        UCB1CTLW0 &= ~UCSWRST;
+    }
+
+    static void shutdown()
+    {
+        UCB1CTLW0 = UCSWRST;
+    }
+
+    static void begin()
+    {
+        P5OUT &= ~CS;
+        delay<1>();
+    }
+
+    static void end()
+    {
+        delay<1>();
+        P5OUT |= CS;
+    }
+
+    static uint8_t readWrite(uint8_t data)
+    {
+        while (!(UCB1IFG & UCTXIFG));
+        UCB1TXBUF = data;
+        while (!(UCB1IFG & UCRXIFG));
+        return UCB1RXBUF;
+    }
+
+    template <uint32_t us>
+    static void delay()
+    {
+        // The template parameter keeps the cycle count a compile-time constant
+        __delay_cycles((unsigned long)us*(MCLK/1000000));
+    }
+};
+#endif
+
+// There is no Linux policy. The policy contract is byte-level, which on spidev means one system
+// call per byte with chip select lost in between; use the C driver's batched spidev port there.
+
+} // namespace pmw3360
+
+#endif //PMW3360_HPP__
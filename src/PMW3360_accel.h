@@ -0,0 +1,68 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Generated by tools/gen_accel_lut.py, do not edit.
+ */
+
+#ifndef PMW3360_ACCEL_H__
+#define PMW3360_ACCEL_H__
+
+#include <stdint.h>
+
+#define PMW3360_ACCEL_LUT_SIZE                      64
+
+static const uint16_t PMW3360_accelLinear[PMW3360_ACCEL_LUT_SIZE] = {
+    0x0100, 0x0108, 0x0110, 0x0118, 0x0121, 0x0129, 0x0131, 0x0139,
+    0x0141, 0x0149, 0x0151, 0x0159, 0x0162, 0x016a, 0x0172, 0x017a,
+    0x0182, 0x018a, 0x0192, 0x019a, 0x01a3, 0x01ab, 0x01b3, 0x01bb,
+    0x01c3, 0x01cb, 0x01d3, 0x01db, 0x01e4, 0x01ec, 0x01f4, 0x01fc,
+    0x0204, 0x020c, 0x0214, 0x021c, 0x0225, 0x022d, 0x0235, 0x023d,
+    0x0245, 0x024d, 0x0255, 0x025d, 0x0266, 0x026e, 0x0276, 0x027e,
+    0x0286, 0x028e, 0x0296, 0x029e, 0x02a7, 0x02af, 0x02b7, 0x02bf,
+    0x02c7, 0x02cf, 0x02d7, 0x02df, 0x02e8, 0x02f0, 0x02f8, 0x0300
+};
+
+static const uint16_t PMW3360_accelPower[PMW3360_ACCEL_LUT_SIZE] = {
+    0x0100, 0x0101, 0x0103, 0x0105, 0x0108, 0x010b, 0x010f, 0x0113,
+    0x0117, 0x011c, 0x0120, 0x0125, 0x012b, 0x0130, 0x0136, 0x013b,
+    0x0142, 0x0148, 0x014e, 0x0155, 0x015c, 0x0163, 0x016a, 0x0171,
+    0x0178, 0x0180, 0x0188, 0x0190, 0x0198, 0x01a0, 0x01a8, 0x01b1,
+    0x01b9, 0x01c2, 0x01cb, 0x01d4, 0x01dd, 0x01e6, 0x01f0, 0x01f9,
+    0x0203, 0x020d, 0x0217, 0x0221, 0x022b, 0x0235, 0x023f, 0x024a,
+    0x0255, 0x025f, 0x026a, 0x0275, 0x0280, 0x028b, 0x0296, 0x02a2,
+    0x02ad, 0x02b9, 0x02c4, 0x02d0, 0x02dc, 0x02e8, 0x02f4, 0x0300
+};
+
+static const uint16_t PMW3360_accelSigmoid[PMW3360_ACCEL_LUT_SIZE] = {
+    0x0100, 0x0100, 0x0101, 0x0101, 0x0101, 0x0102, 0x0103, 0x0104,
+    0x0105, 0x0106, 0x0107, 0x0109, 0x010b, 0x010d, 0x0110, 0x0114,
+    0x0118, 0x011d, 0x0123, 0x012a, 0x0132, 0x013c, 0x0147, 0x0154,
+    0x0162, 0x0172, 0x0184, 0x0198, 0x01ad, 0x01c4, 0x01db, 0x01f4,
+    0x020c, 0x0225, 0x023c, 0x0253, 0x0268, 0x027c, 0x028e, 0x029e,
+    0x02ac, 0x02b9, 0x02c4, 0x02ce, 0x02d6, 0x02dd, 0x02e3, 0x02e8,
+    0x02ec, 0x02f0, 0x02f3, 0x02f5, 0x02f7, 0x02f9, 0x02fa, 0x02fb,
+    0x02fc, 0x02fd, 0x02fe, 0x02ff, 0x02ff, 0x02ff, 0x0300, 0x0300
+};
+
+#endif //PMW3360_ACCEL_H__
@@ -0,0 +1,167 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_filter.h"
+#include "PMW3360_accel.h"
+
+#if (PMW3360_FILTER_WINDOW & (PMW3360_FILTER_WINDOW - 1)) != 0
+#error "PMW3360_FILTER_WINDOW must be a power of two"
+#endif
+
+// Largest scaled displacement (Q8) fed into the smoothing stage
+#define PMW3360_FILTER_LIMIT                        ((int32_t)1 << 21)
+
+/*
+ * Absolute value of a 32-bit integer.
+ */
+static inline int32_t PMW3360_filter_abs(int32_t x)
+{
+    return x < 0 ? -x : x;
+}
+
+/*
+ * Look up the acceleration gain (Q8) for a curve index.
+ */
+static inline int32_t PMW3360_filter_gain(uint8_t curve, uint8_t index)
+{
+    switch (curve) {
+    case PMW3360_ACCEL_LINEAR:
+        return PMW3360_accelLinear[index];
+    case PMW3360_ACCEL_POWER:
+        return PMW3360_accelPower[index];
+    case PMW3360_ACCEL_SIGMOID:
+        return PMW3360_accelSigmoid[index];
+    default:
+        return 256;
+    }
+}
+
+/*
+ * Initialize the filter and clear its state.
+ */
+void PMW3360_filter_init(PMW3360_filter *filter, PMW3360_accelCurve curve,
+                         PMW3360_smoothing smoothing, uint8_t alpha, uint8_t beta)
+{
+    filter->curve = curve;
+    filter->smoothing = smoothing;
+    filter->alpha = alpha;
+    filter->beta = beta;
+    PMW3360_filter_reset(filter);
+
+    return;
+}
+
+/*
+ * Clear the filter history without changing its configuration.
+ */
+void PMW3360_filter_reset(PMW3360_filter *filter)
+{
+    uint8_t i;
+
+    for (i = 0; i < PMW3360_FILTER_WINDOW; i++) {
+        filter->windowX[i] = 0;
+        filter->windowY[i] = 0;
+    }
+    filter->head = 0;
+    filter->sumX = 0;
+    filter->sumY = 0;
+    filter->smoothX = 0;
+    filter->smoothY = 0;
+    filter->remX = 0;
+    filter->remY = 0;
+    filter->stepRemX = 0;
+    filter->stepRemY = 0;
+
+    return;
+}
+
+/*
+ * Apply acceleration and smoothing to one sample in place.
+ */
+void PMW3360_filter_apply(PMW3360_filter *filter, PMW3360_data *data)
+{
+    int32_t ax, ay, speed, gain, x, y, alpha, step;
+    uint8_t index;
+
+    // Slide the velocity window, keeping running sums so the cost is independent of its length
+    filter->sumX += data->dx - filter->windowX[filter->head];
+    filter->sumY += data->dy - filter->windowY[filter->head];
+    filter->windowX[filter->head] = data->dx;
+    filter->windowY[filter->head] = data->dy;
+    filter->head = (filter->head + 1) & (PMW3360_FILTER_WINDOW - 1);
+
+    // Approximate the speed magnitude as max + min/2 to avoid a square root
+    ax = PMW3360_filter_abs(filter->sumX);
+    ay = PMW3360_filter_abs(filter->sumY);
+    speed = ax > ay ? ax + (ay >> 1) : ay + (ax >> 1);
+
+    // Saturate the speed into the curve index and look up the gain
+    speed >>= PMW3360_FILTER_SPEED_SHIFT;
+    index = speed < PMW3360_ACCEL_LUT_SIZE ? (uint8_t)speed : PMW3360_ACCEL_LUT_SIZE - 1;
+    gain = PMW3360_filter_gain(filter->curve, index);
+
+    // Scale the displacement, result is Q8
+    x = (int32_t)data->dx * gain;
+    y = (int32_t)data->dy * gain;
+
+    // Smooth the scaled displacement, the 1-euro filter raises alpha with speed to keep lag low
+    if (filter->smoothing != PMW3360_SMOOTHING_NONE) {
+        // Bound the input so the alpha product stays within 32 bits
+        x = x < -PMW3360_FILTER_LIMIT ? -PMW3360_FILTER_LIMIT : (x > PMW3360_FILTER_LIMIT ? PMW3360_FILTER_LIMIT : x);
+        y = y < -PMW3360_FILTER_LIMIT ? -PMW3360_FILTER_LIMIT : (y > PMW3360_FILTER_LIMIT ? PMW3360_FILTER_LIMIT : y);
+
+        alpha = filter->alpha;
+        if (filter->smoothing == PMW3360_SMOOTHING_ONE_EURO) {
+            alpha += ((int32_t)filter->beta * index) >> 8;
+            alpha = alpha < 256 ? alpha : 256;
+        }
+
+        // Divide the step toward zero and carry its remainder, so the average settles on the input from either side
+        step = (x - filter->smoothX) * alpha + filter->stepRemX;
+        filter->smoothX += step / 256;
+        filter->stepRemX = (int16_t)(step % 256);
+        step = (y - filter->smoothY) * alpha + filter->stepRemY;
+        filter->smoothY += step / 256;
+        filter->stepRemY = (int16_t)(step % 256);
+        x = filter->smoothX;
+        y = filter->smoothY;
+    }
+
+    // Add the remainder from the previous sample and keep the new sub-count remainder
+    x += filter->remX;
+    y += filter->remY;
+    filter->remX = x % 256;
+    filter->remY = y % 256;
+    x /= 256;
+    y /= 256;
+
+    // Saturate to the sensor's 16-bit range
+    data->dx = (int16_t)(x < INT16_MIN ? INT16_MIN : (x > INT16_MAX ? INT16_MAX : x));
+    data->dy = (int16_t)(y < INT16_MIN ? INT16_MIN : (y > INT16_MAX ? INT16_MAX : y));
+
+    return;
+}
@@ -0,0 +1,120 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_FILTER_H__
+#define PMW3360_FILTER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+
+// Number of samples used for velocity estimation, must be a power of two
+#ifndef PMW3360_FILTER_WINDOW
+#define PMW3360_FILTER_WINDOW                       4
+#endif
+
+// Right shift applied to the window speed (counts per window) to get the curve index
+#ifndef PMW3360_FILTER_SPEED_SHIFT
+#define PMW3360_FILTER_SPEED_SHIFT                  2
+#endif
+
+/**
+ * @brief Acceleration curves available to the filter
+ */
+typedef enum PMW3360_accelCurve
+{
+    PMW3360_ACCEL_NONE = 0,     /**< Unity gain */
+    PMW3360_ACCEL_LINEAR,       /**< Gain rises linearly with speed */
+    PMW3360_ACCEL_POWER,        /**< Gain rises with a power of speed */
+    PMW3360_ACCEL_SIGMOID       /**< Gain switches smoothly between a low and a high level */
+} PMW3360_accelCurve;
+
+/**
+ * @brief Smoothing stages available to the filter
+ */
+typedef enum PMW3360_smoothing
+{
+    PMW3360_SMOOTHING_NONE = 0, /**< No smoothing */
+    PMW3360_SMOOTHING_EMA,      /**< Exponential moving average with fixed alpha */
+    PMW3360_SMOOTHING_ONE_EURO  /**< 1-euro filter, alpha rises with speed */
+} PMW3360_smoothing;
+
+/**
+ * @brief State of the pointer acceleration and smoothing filter
+ */
+typedef struct PMW3360_filter
+{
+    uint8_t curve;                              /**< Acceleration curve, one of PMW3360_accelCurve */
+    uint8_t smoothing;                          /**< Smoothing stage, one of PMW3360_smoothing */
+    uint8_t alpha;                              /**< EMA alpha, or 1-euro minimum alpha (Q0.8) */
+    uint8_t beta;                               /**< 1-euro alpha increase per unit of curve index (Q0.8) */
+    uint8_t head;                               /**< Next slot in the velocity window */
+    int16_t windowX[PMW3360_FILTER_WINDOW];     /**< Recent x displacements */
+    int16_t windowY[PMW3360_FILTER_WINDOW];     /**< Recent y displacements */
+    int32_t sumX;                               /**< Sum of windowX */
+    int32_t sumY;                               /**< Sum of windowY */
+    int32_t smoothX;                            /**< Smoothed x displacement (Q8) */
+    int32_t smoothY;                            /**< Smoothed y displacement (Q8) */
+    int32_t remX;                               /**< Sub-count x remainder carried to the next sample (Q8) */
+    int32_t remY;                               /**< Sub-count y remainder carried to the next sample (Q8) */
+    int16_t stepRemX;                           /**< Remainder of the x smoothing step carried to the next sample (Q16) */
+    int16_t stepRemY;                           /**< Remainder of the y smoothing step carried to the next sample (Q16) */
+} PMW3360_filter;
+
+/**
+ * @brief Initialize the filter and clear its state.
+ *
+ * @param filter Pointer to the filter to initialize.
+ * @param curve Acceleration curve to apply.
+ * @param smoothing Smoothing stage to apply.
+ * @param alpha EMA alpha, or minimum alpha for the 1-euro filter (Q0.8, 256 would be no smoothing).
+ * @param beta 1-euro alpha increase per unit of curve index (Q0.8), ignored otherwise.
+ * @return none
+ */
+void PMW3360_filter_init(PMW3360_filter *filter, PMW3360_accelCurve curve,
+                         PMW3360_smoothing smoothing, uint8_t alpha, uint8_t beta);
+
+/**
+ * @brief Clear the filter history without changing its configuration.
+ *
+ * @param filter Pointer to the filter to reset.
+ * @return none
+ */
+void PMW3360_filter_reset(PMW3360_filter *filter);
+
+/**
+ * @brief Apply acceleration and smoothing to one sample in place.
+ *
+ * Runs in constant time using integer arithmetic only. Sub-count motion is
+ * carried to the next sample so no displacement is lost to rounding, and
+ * every division rounds toward zero so motion in either direction is
+ * treated the same.
+ *
+ * @param filter Pointer to the filter state.
+ * @param data Sample read by PMW3360_read, dx and dy are replaced.
+ * @return none
+ */
+void PMW3360_filter_apply(PMW3360_filter *filter, PMW3360_data *data);
+
+#endif //PMW3360_FILTER_H__
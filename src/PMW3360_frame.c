@@ -0,0 +1,370 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "PMW3360.h"
+#include "PMW3360_frame.h"
+
+// Kernel selection, word-parallel code unless SIMD is enabled and the target has it
+#if PMW3360_FRAME_SIMD && defined(__SSE2__)
+#define PMW3360_FRAME_SSE2      1
+#define PMW3360_FRAME_NEON      0
+#include <emmintrin.h>
+#elif PMW3360_FRAME_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#define PMW3360_FRAME_SSE2      0
+#define PMW3360_FRAME_NEON      1
+#include <arm_neon.h>
+#else
+#define PMW3360_FRAME_SSE2      0
+#define PMW3360_FRAME_NEON      0
+#endif
+
+// Mask selecting the even bytes of a word, each in its own 16-bit lane
+#define PMW3360_FRAME_LANES     0x00ff00ffu
+
+/*
+ * Load four pixels as a word, the compiler turns this into a single load where alignment allows.
+ */
+static inline uint32_t PMW3360_frame_word(const uint8_t *pixels)
+{
+    uint32_t word;
+
+    memcpy(&word, pixels, sizeof(word));
+    return word;
+}
+
+#if !PMW3360_FRAME_SSE2 && !PMW3360_FRAME_NEON
+/*
+ * Mask of 16-bit lanes where a >= b, for 8-bit values held in PMW3360_FRAME_LANES.
+ */
+static inline uint32_t PMW3360_frame_ge(uint32_t a, uint32_t b)
+{
+    // Bit 8 of each lane survives the subtraction only when a >= b, lanes never borrow from each other
+    uint32_t t = (a | 0x01000100u) - b;
+
+    return ((t >> 8) & 0x00010001u)*0xff;
+}
+
+/*
+ * Absolute difference of 8-bit values held in PMW3360_FRAME_LANES.
+ */
+static inline uint32_t PMW3360_frame_absdiff(uint32_t a, uint32_t b)
+{
+    uint32_t t = (a | 0x01000100u) - b;
+    uint32_t mask = ((t >> 8) & 0x00010001u)*0xff;
+    uint32_t d = t & PMW3360_FRAME_LANES;
+    uint32_t neg = ((d ^ PMW3360_FRAME_LANES) + 0x00010001u) & PMW3360_FRAME_LANES;
+
+    return (d & mask) | (neg & ~mask);
+}
+
+/*
+ * Sum of absolute differences of two four-pixel words.
+ */
+static inline uint32_t PMW3360_frame_sad(uint32_t a, uint32_t b)
+{
+    uint32_t d = PMW3360_frame_absdiff(a & PMW3360_FRAME_LANES, b & PMW3360_FRAME_LANES) +
+                 PMW3360_frame_absdiff((a >> 8) & PMW3360_FRAME_LANES, (b >> 8) & PMW3360_FRAME_LANES);
+
+    return (d & 0xffff) + (d >> 16);
+}
+#endif
+
+/*
+ * Build a 256-bin histogram of a frame.
+ */
+void PMW3360_frame_histogram(const uint8_t *frame, uint16_t *histogram)
+{
+    uint16_t i;
+    uint32_t word;
+
+    for (i = 0; i < 256; i++) {
+        histogram[i] = 0;
+    }
+
+    // Binning is inherently scalar, loading a word at a time halves the memory accesses
+    for (i = 0; i < PMW3360_FRAME_SIZE; i += 4) {
+        word = PMW3360_frame_word(&frame[i]);
+        histogram[word & 0xff]++;
+        histogram[(word >> 8) & 0xff]++;
+        histogram[(word >> 16) & 0xff]++;
+        histogram[word >> 24]++;
+    }
+
+    return;
+}
+
+/*
+ * Compute min, max, mean and variance of a frame.
+ */
+void PMW3360_frame_stats(const uint8_t *frame, PMW3360_frameStats *stats)
+{
+    uint32_t sum = 0;
+    uint32_t squares = 0;
+    uint64_t variance;
+    uint16_t i;
+
+#if PMW3360_FRAME_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmin = _mm_set1_epi8((char)0xff);
+    __m128i vmax = zero;
+    __m128i vsum = zero;
+    __m128i vsquares = zero;
+    __m128i v, lo, hi;
+    uint8_t lanes[16];
+
+    for (i = 0; i < PMW3360_FRAME_SIZE; i += 16) {
+        v = _mm_loadu_si128((const __m128i *)&frame[i]);
+        vmin = _mm_min_epu8(vmin, v);
+        vmax = _mm_max_epu8(vmax, v);
+        vsum = _mm_add_epi64(vsum, _mm_sad_epu8(v, zero));
+        lo = _mm_unpacklo_epi8(v, zero);
+        hi = _mm_unpackhi_epi8(v, zero);
+        vsquares = _mm_add_epi32(vsquares, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+    }
+    sum = (uint32_t)_mm_cvtsi128_si32(vsum) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(vsum, 8));
+    vsquares = _mm_add_epi32(vsquares, _mm_srli_si128(vsquares, 8));
+    vsquares = _mm_add_epi32(vsquares, _mm_srli_si128(vsquares, 4));
+    squares = (uint32_t)_mm_cvtsi128_si32(vsquares);
+    _mm_storeu_si128((__m128i *)lanes, vmin);
+    stats->min = 0xff;
+    for (i = 0; i < 16; i++) {
+        stats->min = lanes[i] < stats->min ? lanes[i] : stats->min;
+    }
+    _mm_storeu_si128((__m128i *)lanes, vmax);
+    stats->max = 0;
+    for (i = 0; i < 16; i++) {
+        stats->max = lanes[i] > stats->max ? lanes[i] : stats->max;
+    }
+#elif PMW3360_FRAME_NEON
+    uint8x16_t vmin = vdupq_n_u8(0xff);
+    uint8x16_t vmax = vdupq_n_u8(0);
+    uint32x4_t vsum = vdupq_n_u32(0);
+    uint32x4_t vsquares = vdupq_n_u32(0);
+    uint8x16_t v;
+
+    for (i = 0; i < PMW3360_FRAME_SIZE; i += 16) {
+        v = vld1q_u8(&frame[i]);
+        vmin = vminq_u8(vmin, v);
+        vmax = vmaxq_u8(vmax, v);
+        vsum = vpadalq_u16(vsum, vpaddlq_u8(v));
+        vsquares = vpadalq_u16(vsquares, vmull_u8(vget_low_u8(v), vget_low_u8(v)));
+        vsquares = vpadalq_u16(vsquares, vmull_u8(vget_high_u8(v), vget_high_u8(v)));
+    }
+    sum = vaddvq_u32(vsum);
+    squares = vaddvq_u32(vsquares);
+    stats->min = vminvq_u8(vmin);
+    stats->max = vmaxvq_u8(vmax);
+#else
+    uint32_t word, even, odd, ge, high, low;
+    uint32_t lanes = 0;
+    uint32_t minLanes = PMW3360_FRAME_LANES;
+    uint32_t maxLanes = 0;
+    uint8_t pixel;
+
+    for (i = 0; i < PMW3360_FRAME_SIZE; i += 4) {
+        word = PMW3360_frame_word(&frame[i]);
+        even = word & PMW3360_FRAME_LANES;
+        odd = (word >> 8) & PMW3360_FRAME_LANES;
+
+        // Sum two pixels per 16-bit lane, flushing before a lane can overflow
+        lanes += even + odd;
+        if ((i & 0x1fc) == 0x1fc) {
+            sum += (lanes & 0xffff) + (lanes >> 16);
+            lanes = 0;
+        }
+
+        // Track min and max two lanes at a time
+        ge = PMW3360_frame_ge(even, odd);
+        high = (even & ge) | (odd & ~ge);
+        low = (odd & ge) | (even & ~ge);
+        ge = PMW3360_frame_ge(high, maxLanes);
+        maxLanes = (high & ge) | (maxLanes & ~ge);
+        ge = PMW3360_frame_ge(low, minLanes);
+        minLanes = (minLanes & ge) | (low & ~ge);
+
+        // Squares need a multiply per pixel
+        pixel = (uint8_t)word;
+        squares += (uint32_t)pixel*pixel;
+        pixel = (uint8_t)(word >> 8);
+        squares += (uint32_t)pixel*pixel;
+        pixel = (uint8_t)(word >> 16);
+        squares += (uint32_t)pixel*pixel;
+        pixel = (uint8_t)(word >> 24);
+        squares += (uint32_t)pixel*pixel;
+    }
+    sum += (lanes & 0xffff) + (lanes >> 16);
+    stats->min = (uint8_t)((minLanes & 0xff) < (minLanes >> 16) ? (minLanes & 0xff) : (minLanes >> 16));
+    stats->max = (uint8_t)((maxLanes & 0xff) > (maxLanes >> 16) ? (maxLanes & 0xff) : (maxLanes >> 16));
+#endif
+
+    // Mean and variance in Q8, variance = (N*sum(x^2) - sum(x)^2) / N^2
+    stats->mean = (uint16_t)(((uint32_t)sum << 8) / PMW3360_FRAME_SIZE);
+    variance = (uint64_t)squares*PMW3360_FRAME_SIZE - (uint64_t)sum*sum;
+    stats->variance = (uint32_t)((variance << 8) / ((uint32_t)PMW3360_FRAME_SIZE*PMW3360_FRAME_SIZE));
+
+    return;
+}
+
+/*
+ * Compute a gradient-based sharpness measure of a frame.
+ */
+uint32_t PMW3360_frame_sharpness(const uint8_t *frame)
+{
+    const uint8_t *row;
+    uint32_t sharpness = 0;
+    uint8_t r, i;
+
+    for (r = 0; r < PMW3360_FRAME_WIDTH; r++) {
+        row = &frame[r*PMW3360_FRAME_WIDTH];
+
+        // Horizontal neighbours, pixels 0-32 compared in parallel, the last three pairs one at a time
+#if PMW3360_FRAME_SSE2
+        {
+            __m128i sad = _mm_add_epi64(
+                _mm_sad_epu8(_mm_loadu_si128((const __m128i *)&row[0]), _mm_loadu_si128((const __m128i *)&row[1])),
+                _mm_sad_epu8(_mm_loadu_si128((const __m128i *)&row[16]), _mm_loadu_si128((const __m128i *)&row[17])));
+            sharpness += (uint32_t)_mm_cvtsi128_si32(sad) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(sad, 8));
+        }
+#elif PMW3360_FRAME_NEON
+        sharpness += vaddlvq_u8(vabdq_u8(vld1q_u8(&row[0]), vld1q_u8(&row[1])));
+        sharpness += vaddlvq_u8(vabdq_u8(vld1q_u8(&row[16]), vld1q_u8(&row[17])));
+#else
+        for (i = 0; i < 32; i += 4) {
+            sharpness += PMW3360_frame_sad(PMW3360_frame_word(&row[i]), PMW3360_frame_word(&row[i + 1]));
+        }
+#endif
+        for (i = 32; i < PMW3360_FRAME_WIDTH - 1; i++) {
+            sharpness += row[i] > row[i + 1] ? row[i] - row[i + 1] : row[i + 1] - row[i];
+        }
+
+        // Vertical neighbours, rows are a multiple of four pixels so every word lines up
+        if (r == PMW3360_FRAME_WIDTH - 1) {
+            break;
+        }
+#if PMW3360_FRAME_SSE2
+        {
+            __m128i sad = _mm_add_epi64(
+                _mm_sad_epu8(_mm_loadu_si128((const __m128i *)&row[0]),
+                             _mm_loadu_si128((const __m128i *)&row[PMW3360_FRAME_WIDTH])),
+                _mm_sad_epu8(_mm_loadu_si128((const __m128i *)&row[16]),
+                             _mm_loadu_si128((const __m128i *)&row[PMW3360_FRAME_WIDTH + 16])));
+            sharpness += (uint32_t)_mm_cvtsi128_si32(sad) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(sad, 8));
+        }
+        for (i = 32; i < PMW3360_FRAME_WIDTH; i++) {
+            sharpness += row[i] > row[i + PMW3360_FRAME_WIDTH] ? row[i] - row[i + PMW3360_FRAME_WIDTH] :
+                                                                  row[i + PMW3360_FRAME_WIDTH] - row[i];
+        }
+#elif PMW3360_FRAME_NEON
+        sharpness += vaddlvq_u8(vabdq_u8(vld1q_u8(&row[0]), vld1q_u8(&row[PMW3360_FRAME_WIDTH])));
+        sharpness += vaddlvq_u8(vabdq_u8(vld1q_u8(&row[16]), vld1q_u8(&row[PMW3360_FRAME_WIDTH + 16])));
+        for (i = 32; i < PMW3360_FRAME_WIDTH; i++) {
+            sharpness += row[i] > row[i + PMW3360_FRAME_WIDTH] ? row[i] - row[i + PMW3360_FRAME_WIDTH] :
+                                                                  row[i + PMW3360_FRAME_WIDTH] - row[i];
+        }
+#else
+        for (i = 0; i < PMW3360_FRAME_WIDTH; i += 4) {
+            sharpness += PMW3360_frame_sad(PMW3360_frame_word(&row[i]),
+                                           PMW3360_frame_word(&row[i + PMW3360_FRAME_WIDTH]));
+        }
+#endif
+    }
+
+    return sharpness;
+}
+
+/*
+ * Clear a fixed-pattern-noise accumulator.
+ */
+void PMW3360_fpn_init(PMW3360_fpn *fpn)
+{
+    memset(fpn->sum, 0, sizeof(fpn->sum));
+    fpn->frames = 0;
+
+    return;
+}
+
+/*
+ * Add one frame to a fixed-pattern-noise accumulator.
+ */
+bool PMW3360_fpn_add(PMW3360_fpn *fpn, const uint8_t *frame)
+{
+    uint16_t i;
+    uint32_t word;
+
+    if (fpn->frames >= PMW3360_FPN_MAX_FRAMES) {
+        return false;
+    }
+
+    // Two pixels per word in 16-bit lanes, a lane holds 257 frames of 255 without carrying
+    for (i = 0; i < PMW3360_FRAME_SIZE; i += 4) {
+        word = PMW3360_frame_word(&frame[i]);
+        fpn->sum[i/2] += word & PMW3360_FRAME_LANES;
+        fpn->sum[i/2 + 1] += (word >> 8) & PMW3360_FRAME_LANES;
+    }
+    fpn->frames++;
+
+    return true;
+}
+
+/*
+ * Estimate fixed-pattern noise as the spatial variance of the per-pixel mean.
+ */
+uint32_t PMW3360_fpn_estimate(const PMW3360_fpn *fpn)
+{
+    uint64_t sum = 0;
+    uint64_t squares = 0;
+    uint64_t n;
+    uint32_t lane;
+    uint16_t i;
+
+    if (fpn->frames == 0) {
+        return 0;
+    }
+
+    for (i = 0; i < PMW3360_FRAME_SIZE/2; i++) {
+        lane = fpn->sum[i] & 0xffff;
+        sum += lane;
+        squares += (uint64_t)lane*lane;
+        lane = fpn->sum[i] >> 16;
+        sum += lane;
+        squares += (uint64_t)lane*lane;
+    }
+
+    // Variance of the per-pixel means in Q8, (P*sum(S^2) - sum(S)^2) / (N*P)^2
+    n = (uint64_t)fpn->frames*PMW3360_FRAME_SIZE;
+    return (uint32_t)(((squares*PMW3360_FRAME_SIZE - sum*sum) << 8) / (n*n));
+}
+
+#if PMW3360_FRAME_FILES
+/*
+ * Load the next frame from a file of concatenated raw frames.
+ */
+bool PMW3360_frame_load(FILE *file, uint8_t *frame)
+{
+    return fread(frame, 1, PMW3360_FRAME_SIZE, file) == PMW3360_FRAME_SIZE;
+}
+#endif
@@ -0,0 +1,141 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_FRAME_H__
+#define PMW3360_FRAME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+
+// Loading frames from files is only available on hosted platforms
+#ifndef PMW3360_FRAME_FILES
+#if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
+#define PMW3360_FRAME_FILES                         1
+#else
+#define PMW3360_FRAME_FILES                         0
+#endif
+#endif
+
+#if PMW3360_FRAME_FILES
+#include <stdio.h>
+#endif
+
+// Use the SSE2 or NEON kernels where the target has them, 0 forces the word-parallel kernels
+#ifndef PMW3360_FRAME_SIMD
+#define PMW3360_FRAME_SIMD                          1
+#endif
+
+// Number of frames a PMW3360_fpn accumulator can hold without overflowing
+#define PMW3360_FPN_MAX_FRAMES                      257
+
+/**
+ * @brief Intensity statistics of one frame
+ */
+typedef struct PMW3360_frameStats
+{
+    uint8_t min;            /**< Smallest pixel value */
+    uint8_t max;            /**< Largest pixel value */
+    uint16_t mean;          /**< Mean pixel value (Q8) */
+    uint32_t variance;      /**< Pixel variance (Q8) */
+} PMW3360_frameStats;
+
+/**
+ * @brief Per-pixel accumulator for fixed-pattern-noise estimation
+ */
+typedef struct PMW3360_fpn
+{
+    uint32_t sum[PMW3360_FRAME_SIZE/2];     /**< Per-pixel sums, two 16-bit lanes per word */
+    uint16_t frames;                        /**< Number of frames accumulated */
+} PMW3360_fpn;
+
+/**
+ * @brief Build a 256-bin histogram of a frame.
+ *
+ * @param frame Frame of PMW3360_FRAME_SIZE bytes.
+ * @param histogram Array of 256 bins, overwritten.
+ * @return none
+ */
+void PMW3360_frame_histogram(const uint8_t *frame, uint16_t *histogram);
+
+/**
+ * @brief Compute min, max, mean and variance of a frame.
+ *
+ * @param frame Frame of PMW3360_FRAME_SIZE bytes.
+ * @param stats Pointer to PMW3360_frameStats structure to write into.
+ * @return none
+ */
+void PMW3360_frame_stats(const uint8_t *frame, PMW3360_frameStats *stats);
+
+/**
+ * @brief Compute a gradient-based sharpness measure of a frame.
+ *
+ * Sum of absolute differences between horizontally and vertically
+ * adjacent pixels, higher is sharper. Useful for optics focus checks.
+ *
+ * @param frame Frame of PMW3360_FRAME_SIZE bytes.
+ * @return Sharpness
+ */
+uint32_t PMW3360_frame_sharpness(const uint8_t *frame);
+
+/**
+ * @brief Clear a fixed-pattern-noise accumulator.
+ *
+ * @param fpn Pointer to the accumulator.
+ * @return none
+ */
+void PMW3360_fpn_init(PMW3360_fpn *fpn);
+
+/**
+ * @brief Add one frame to a fixed-pattern-noise accumulator.
+ *
+ * @param fpn Pointer to the accumulator.
+ * @param frame Frame of PMW3360_FRAME_SIZE bytes.
+ * @return False if the accumulator already holds PMW3360_FPN_MAX_FRAMES frames
+ */
+bool PMW3360_fpn_add(PMW3360_fpn *fpn, const uint8_t *frame);
+
+/**
+ * @brief Estimate fixed-pattern noise as the spatial variance of the per-pixel mean.
+ *
+ * Temporal noise contributes its variance divided by the frame count, so
+ * accumulate enough frames for it to become negligible.
+ *
+ * @param fpn Pointer to the accumulator.
+ * @return Variance (Q8), zero if no frames were added
+ */
+uint32_t PMW3360_fpn_estimate(const PMW3360_fpn *fpn);
+
+#if PMW3360_FRAME_FILES
+/**
+ * @brief Load the next frame from a file of concatenated raw frames.
+ *
+ * @param file File opened for binary reading.
+ * @param frame Buffer of PMW3360_FRAME_SIZE bytes.
+ * @return False at the end of the file or on a short read
+ */
+bool PMW3360_frame_load(FILE *file, uint8_t *frame);
+#endif
+
+#endif //PMW3360_FRAME_H__
@@ -0,0 +1,162 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_fusion.h"
+
+#if !PMW3360_ENABLE_DIAGNOSTICS
+#error "PMW3360_fusion.c needs PMW3360_ENABLE_DIAGNOSTICS for the SQUAL field"
+#endif
+
+// Micrometers per inch, used to convert counts to distance
+#define PMW3360_FUSION_UM_PER_INCH                  25400
+
+/*
+ * Integer square root of a 64-bit value.
+ */
+static uint32_t PMW3360_fusion_sqrt(uint64_t x)
+{
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    // Find the highest power of four not greater than x
+    while (bit > x) {
+        bit >>= 2;
+    }
+
+    // Compute the root one bit at a time
+    while (bit != 0) {
+        if (x >= result + bit) {
+            x -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)result;
+}
+
+/*
+ * Build the matrix converting sensor counts to body frame micrometers (Q16).
+ */
+static void PMW3360_fusion_transform(int32_t *transform, const PMW3360_fusionSensor *sensor)
+{
+    int64_t scale;
+
+    // Micrometers per count in Q16, combined with the Q14 rotation gives Q30, shift back to Q16
+    scale = ((int64_t)PMW3360_FUSION_UM_PER_INCH << 16) / sensor->cpi;
+    transform[0] = (int32_t)((scale * sensor->cosAngle) >> 14);
+    transform[1] = (int32_t)((-scale * sensor->sinAngle) >> 14);
+    transform[2] = (int32_t)((scale * sensor->sinAngle) >> 14);
+    transform[3] = (int32_t)((scale * sensor->cosAngle) >> 14);
+
+    return;
+}
+
+/*
+ * Precompute the fusion parameters for a pair of sensors.
+ */
+bool PMW3360_fusion_init(PMW3360_fusion *fusion, const PMW3360_fusionSensor *first,
+                         const PMW3360_fusionSensor *second, uint8_t minSQUAL)
+{
+    int64_t bx, by;
+
+    // Both sensors must report a resolution and sit at different positions
+    bx = (int64_t)second->x - first->x;
+    by = (int64_t)second->y - first->y;
+    if (first->cpi == 0 || second->cpi == 0 || (bx == 0 && by == 0)) {
+        return false;
+    }
+
+    PMW3360_fusion_transform(fusion->transform[0], first);
+    PMW3360_fusion_transform(fusion->transform[1], second);
+
+    // Rotation shows up as relative motion along the normal to the baseline
+    fusion->baseline = (int32_t)PMW3360_fusion_sqrt((uint64_t)(bx*bx + by*by));
+    fusion->normalX = (int32_t)((-by << 14) / fusion->baseline);
+    fusion->normalY = (int32_t)((bx << 14) / fusion->baseline);
+    fusion->centerX = (int32_t)(((int64_t)first->x + second->x) / 2);
+    fusion->centerY = (int32_t)(((int64_t)first->y + second->y) / 2);
+    fusion->minSQUAL = minSQUAL;
+    fusion->remAngle = 0;
+    fusion->remX = 0;
+    fusion->remY = 0;
+
+    return true;
+}
+
+/*
+ * Compute translation and rotation from one pair of samples.
+ */
+uint8_t PMW3360_fusion_update(PMW3360_fusion *fusion, const PMW3360_data *first,
+                              const PMW3360_data *second, PMW3360_motion *motion)
+{
+    const int32_t *t0 = fusion->transform[0];
+    const int32_t *t1 = fusion->transform[1];
+    int64_t x0, y0, x1, y1, relative, angle, x, y;
+    uint8_t flags = 0;
+
+    // Flag samples taken off the surface or on a poor surface
+    if (!first->surface) {
+        flags |= PMW3360_FUSION_LIFT_FIRST;
+    }
+    if (!second->surface) {
+        flags |= PMW3360_FUSION_LIFT_SECOND;
+    }
+    if (first->SQUAL < fusion->minSQUAL) {
+        flags |= PMW3360_FUSION_SQUAL_FIRST;
+    }
+    if (second->SQUAL < fusion->minSQUAL) {
+        flags |= PMW3360_FUSION_SQUAL_SECOND;
+    }
+
+    // Convert each sensor's displacement to body frame micrometers (Q16)
+    x0 = (int64_t)t0[0]*first->dx + (int64_t)t0[1]*first->dy;
+    y0 = (int64_t)t0[2]*first->dx + (int64_t)t0[3]*first->dy;
+    x1 = (int64_t)t1[0]*second->dx + (int64_t)t1[1]*second->dy;
+    y1 = (int64_t)t1[2]*second->dx + (int64_t)t1[3]*second->dy;
+
+    // Rotation is the relative displacement along the baseline normal divided by the baseline,
+    // the remainder of the division is carried so small rotations add up across updates
+    relative = (((x1 - x0)*fusion->normalX + (y1 - y0)*fusion->normalY) >> 14) + fusion->remAngle;
+    angle = relative / fusion->baseline;
+    fusion->remAngle = (int32_t)(relative % fusion->baseline);
+
+    // Translation of the body origin is the mean displacement less the rotation about the midpoint,
+    // summed at twice the scale so the mean is exact, then split into micrometers and a carried remainder
+    x = x0 + x1 + 2*angle*fusion->centerY + fusion->remX;
+    y = y0 + y1 - 2*angle*fusion->centerX + fusion->remY;
+    motion->dx = (int32_t)(x / ((int64_t)2 << 16));
+    motion->dy = (int32_t)(y / ((int64_t)2 << 16));
+    fusion->remX = (int32_t)(x % ((int64_t)2 << 16));
+    fusion->remY = (int32_t)(y % ((int64_t)2 << 16));
+    motion->angle = (int32_t)angle;
+
+    return flags;
+}
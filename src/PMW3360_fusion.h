@@ -0,0 +1,110 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_FUSION_H__
+#define PMW3360_FUSION_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+
+// Convert a cosine or sine value to the Q14 format used for mounting angles
+#define PMW3360_FUSION_Q14(x)                       ((int16_t)((x) * 16384.0 + ((x) < 0 ? -0.5 : 0.5)))
+
+// Flags returned by PMW3360_fusion_update
+#define PMW3360_FUSION_LIFT_FIRST                   0x01
+#define PMW3360_FUSION_LIFT_SECOND                  0x02
+#define PMW3360_FUSION_SQUAL_FIRST                  0x04
+#define PMW3360_FUSION_SQUAL_SECOND                 0x08
+
+/**
+ * @brief Mounting description of one sensor in the body frame
+ */
+typedef struct PMW3360_fusionSensor
+{
+    uint16_t cpi;           /**< Counts per inch the sensor is configured for */
+    int16_t cosAngle;       /**< Cosine of the mounting angle (Q14) */
+    int16_t sinAngle;       /**< Sine of the mounting angle (Q14) */
+    int32_t x;              /**< Position of the sensor on the x axis in micrometers */
+    int32_t y;              /**< Position of the sensor on the y axis in micrometers */
+} PMW3360_fusionSensor;
+
+/**
+ * @brief Precomputed fusion parameters for a pair of sensors
+ */
+typedef struct PMW3360_fusion
+{
+    int32_t transform[2][4];    /**< Per sensor counts to body frame micrometers (Q16) */
+    int32_t centerX;            /**< Midpoint between the sensors on the x axis in micrometers */
+    int32_t centerY;            /**< Midpoint between the sensors on the y axis in micrometers */
+    int32_t normalX;            /**< Unit normal to the baseline, x component (Q14) */
+    int32_t normalY;            /**< Unit normal to the baseline, y component (Q14) */
+    int32_t baseline;           /**< Distance between the sensors in micrometers */
+    uint8_t minSQUAL;           /**< SQUAL below which a sample is flagged unreliable */
+    int32_t remAngle;           /**< Rotation remainder carried to the next update (baseline units) */
+    int32_t remX;               /**< Translation remainder on the x axis carried to the next update (Q17) */
+    int32_t remY;               /**< Translation remainder on the y axis carried to the next update (Q17) */
+} PMW3360_fusion;
+
+/**
+ * @brief Rigid body motion of one frame
+ */
+typedef struct PMW3360_motion
+{
+    int32_t dx;             /**< Translation of the body origin on the x axis in micrometers */
+    int32_t dy;             /**< Translation of the body origin on the y axis in micrometers */
+    int32_t angle;          /**< Rotation counter-clockwise in radians (Q16) */
+} PMW3360_motion;
+
+/**
+ * @brief Precompute the fusion parameters for a pair of sensors.
+ *
+ * Must be called again whenever the DPI of either sensor changes, this also
+ * clears the remainders carried between updates.
+ *
+ * @param fusion Pointer to the fusion parameters to fill in.
+ * @param first Mounting of sensor 0.
+ * @param second Mounting of sensor 1.
+ * @param minSQUAL SQUAL below which a sample is flagged unreliable.
+ * @return False if a CPI is zero or the sensors share a position
+ */
+bool PMW3360_fusion_init(PMW3360_fusion *fusion, const PMW3360_fusionSensor *first,
+                         const PMW3360_fusionSensor *second, uint8_t minSQUAL);
+
+/**
+ * @brief Compute translation and rotation from one pair of samples.
+ *
+ * The parts of a micrometer and of a rotation step that do not fit the
+ * result are carried to the next update, so summed results do not drift.
+ *
+ * @param fusion Pointer to the fusion parameters and carried remainders.
+ * @param first Sample from sensor 0, as read by PMW3360_readPair.
+ * @param second Sample from sensor 1, as read by PMW3360_readPair.
+ * @param motion Pointer to PMW3360_motion structure to write the result into.
+ * @return Zero if both samples are reliable, otherwise PMW3360_FUSION_* flags
+ */
+uint8_t PMW3360_fusion_update(PMW3360_fusion *fusion, const PMW3360_data *first,
+                              const PMW3360_data *second, PMW3360_motion *motion);
+
+#endif //PMW3360_FUSION_H__
@@ -0,0 +1,274 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_liftcal.h"
+
+// Actions of the calibration state machine, one register access each
+enum
+{
+    PMW3360_LIFTCAL_STATE_SAVE_TUNE1 = 0,
+    PMW3360_LIFTCAL_STATE_SAVE_TUNE2,
+    PMW3360_LIFTCAL_STATE_DISABLE,
+    PMW3360_LIFTCAL_STATE_TIMEOUT,
+    PMW3360_LIFTCAL_STATE_MIN_LENGTH,
+    PMW3360_LIFTCAL_STATE_BEGIN,
+    PMW3360_LIFTCAL_STATE_POLL,
+    PMW3360_LIFTCAL_STATE_READ_CONFIG,
+    PMW3360_LIFTCAL_STATE_READ_MIN_SQ,
+    PMW3360_LIFTCAL_STATE_READ_THRESHOLD,
+    PMW3360_LIFTCAL_STATE_THRESHOLD,
+    PMW3360_LIFTCAL_STATE_ENABLE,
+    PMW3360_LIFTCAL_STATE_STOP,
+    PMW3360_LIFTCAL_STATE_RESTORE_TUNE2,
+    PMW3360_LIFTCAL_STATE_RESTORE_TUNE1
+};
+
+/*
+ * Write back the tune values saved at start, the manual cutoff last so it never runs on a foreign threshold.
+ */
+static void PMW3360_liftCal_putBack(const PMW3360_liftCal *cal)
+{
+    PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE2, cal->savedTune2);
+    PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE1, cal->savedTune1);
+
+    return;
+}
+
+/*
+ * Start a lift cutoff calibration.
+ */
+void PMW3360_liftCal_start(PMW3360_liftCal *cal, uint8_t timeout, uint8_t minLength, uint16_t maxPolls)
+{
+    cal->status = PMW3360_LIFTCAL_RUNNING;
+    cal->state = PMW3360_LIFTCAL_STATE_SAVE_TUNE1;
+    cal->timeout = timeout;
+    cal->minLength = minLength;
+    cal->wait = 0;
+    cal->polls = 0;
+    cal->maxPolls = maxPolls ? maxPolls : 1;
+
+    return;
+}
+
+/*
+ * Advance the calibration by at most one register access.
+ */
+PMW3360_liftCalStatus PMW3360_liftCal_step(PMW3360_liftCal *cal)
+{
+    if (cal->status != PMW3360_LIFTCAL_RUNNING) {
+        return (PMW3360_liftCalStatus)cal->status;
+    }
+
+    switch (cal->state) {
+    case PMW3360_LIFTCAL_STATE_SAVE_TUNE1:
+        // Keep the tune values in effect, a calibration that does not finish puts them back
+        cal->savedTune1 = PMW3360_readRegister(PMW3360_REG_LIFTCUTOFF_TUNE1);
+        cal->state = PMW3360_LIFTCAL_STATE_SAVE_TUNE2;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_SAVE_TUNE2:
+        cal->savedTune2 = PMW3360_readRegister(PMW3360_REG_LIFTCUTOFF_TUNE2);
+        cal->state = PMW3360_LIFTCAL_STATE_DISABLE;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_DISABLE:
+        // Disable the manual lift cutoff so tuning starts from the sensor defaults
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE1, 0x00);
+        cal->state = PMW3360_LIFTCAL_STATE_TIMEOUT;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_TIMEOUT:
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE_TIMEOUT, cal->timeout);
+        cal->state = PMW3360_LIFTCAL_STATE_MIN_LENGTH;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_MIN_LENGTH:
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE_MIN_LENGTH, cal->minLength);
+        cal->state = PMW3360_LIFTCAL_STATE_BEGIN;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_BEGIN:
+        // Start tuning, the sensor collects statistics while it is moved over the surface
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE3, PMW3360_LIFTCAL_TUNE3_START);
+        cal->wait = PMW3360_LIFTCAL_POLL_INTERVAL;
+        cal->state = PMW3360_LIFTCAL_STATE_POLL;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_POLL:
+        // Only poll every few steps to keep the added bus time low
+        if (cal->wait > 0) {
+            cal->wait--;
+            break;
+        }
+        cal->wait = PMW3360_LIFTCAL_POLL_INTERVAL;
+
+        // Give up, stopping the tuning is a register access of its own
+        if (cal->polls >= cal->maxPolls) {
+            cal->outcome = PMW3360_LIFTCAL_TIMEOUT;
+            cal->state = PMW3360_LIFTCAL_STATE_STOP;
+            break;
+        }
+        cal->polls++;
+        if ((PMW3360_readRegister(PMW3360_REG_LIFTCUTOFF_TUNE3) & PMW3360_LIFTCAL_TUNE3_START) == 0) {
+            cal->state = PMW3360_LIFTCAL_STATE_READ_CONFIG;
+        }
+        break;
+
+    case PMW3360_LIFTCAL_STATE_READ_CONFIG:
+        cal->tune.liftConfig = PMW3360_readRegister(PMW3360_REG_LIFT_CONFIG);
+        cal->state = PMW3360_LIFTCAL_STATE_READ_MIN_SQ;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_READ_MIN_SQ:
+        cal->tune.minSQRun = PMW3360_readRegister(PMW3360_REG_MIN_SQ_RUN);
+        cal->state = PMW3360_LIFTCAL_STATE_READ_THRESHOLD;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_READ_THRESHOLD:
+        cal->tune.rawDataThreshold = PMW3360_readRegister(PMW3360_REG_RAW_DATA_THRESHOLD);
+
+        // A zero threshold means the sensor never saw enough of the surface
+        if (cal->tune.minSQRun == 0 || cal->tune.rawDataThreshold == 0) {
+            cal->outcome = PMW3360_LIFTCAL_FAILED;
+            cal->state = PMW3360_LIFTCAL_STATE_RESTORE_TUNE2;
+        }
+        else {
+            cal->state = PMW3360_LIFTCAL_STATE_THRESHOLD;
+        }
+        break;
+
+    case PMW3360_LIFTCAL_STATE_THRESHOLD:
+        // The manual lift cutoff takes its threshold from LiftCutoff_Tune2
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE2, cal->tune.rawDataThreshold);
+        cal->state = PMW3360_LIFTCAL_STATE_ENABLE;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_ENABLE:
+        // Switch the sensor over to the tuned lift cutoff, the minimum SQUAL goes with the enable bit
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE1, PMW3360_LIFTCAL_TUNE1_ENABLE |
+                              (cal->tune.minSQRun & PMW3360_LIFTCAL_TUNE1_MIN_SQ_RUN));
+        cal->status = PMW3360_LIFTCAL_DONE;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_STOP:
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE3, 0x00);
+        cal->state = PMW3360_LIFTCAL_STATE_RESTORE_TUNE2;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_RESTORE_TUNE2:
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE2, cal->savedTune2);
+        cal->state = PMW3360_LIFTCAL_STATE_RESTORE_TUNE1;
+        break;
+
+    case PMW3360_LIFTCAL_STATE_RESTORE_TUNE1:
+        PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE1, cal->savedTune1);
+        cal->status = cal->outcome;
+        break;
+
+    default:
+        cal->status = PMW3360_LIFTCAL_FAILED;
+        break;
+    }
+
+    return (PMW3360_liftCalStatus)cal->status;
+}
+
+/*
+ * Abort a running calibration and stop tuning on the sensor.
+ */
+void PMW3360_liftCal_abort(PMW3360_liftCal *cal)
+{
+    if (cal->status == PMW3360_LIFTCAL_RUNNING) {
+        // Tuning only runs on the sensor once it has been started
+        if (cal->state >= PMW3360_LIFTCAL_STATE_POLL && cal->state <= PMW3360_LIFTCAL_STATE_STOP) {
+            PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE3, 0x00);
+        }
+
+        // Tune values change from the disable step on
+        if (cal->state > PMW3360_LIFTCAL_STATE_DISABLE) {
+            PMW3360_liftCal_putBack(cal);
+        }
+        cal->status = PMW3360_LIFTCAL_IDLE;
+    }
+
+    return;
+}
+
+/*
+ * Get the calibration progress.
+ */
+uint8_t PMW3360_liftCal_progress(const PMW3360_liftCal *cal)
+{
+    uint32_t progress;
+
+    if (cal->status == PMW3360_LIFTCAL_DONE) {
+        return 100;
+    }
+    if (cal->status != PMW3360_LIFTCAL_RUNNING) {
+        return 0;
+    }
+
+    // Setup and readback states count for a few percent each, polling fills the rest
+    if (cal->state < PMW3360_LIFTCAL_STATE_POLL) {
+        return cal->state * 2;
+    }
+    if (cal->state >= PMW3360_LIFTCAL_STATE_STOP) {
+        return 98;
+    }
+    if (cal->state > PMW3360_LIFTCAL_STATE_POLL) {
+        return 88 + (cal->state - PMW3360_LIFTCAL_STATE_POLL) * 2;
+    }
+    progress = 12 + ((uint32_t)cal->polls * 76) / cal->maxPolls;
+
+    return (uint8_t)progress;
+}
+
+/*
+ * Copy the tune values of a finished calibration.
+ */
+bool PMW3360_liftCal_save(const PMW3360_liftCal *cal, PMW3360_liftTune *tune)
+{
+    if (cal->status != PMW3360_LIFTCAL_DONE) {
+        return false;
+    }
+    *tune = cal->tune;
+
+    return true;
+}
+
+/*
+ * Apply previously saved tune values to the sensor.
+ */
+void PMW3360_liftCal_restore(const PMW3360_liftTune *tune)
+{
+    PMW3360_writeRegister(PMW3360_REG_LIFT_CONFIG, tune->liftConfig);
+    PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE2, tune->rawDataThreshold);
+    PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE1, PMW3360_LIFTCAL_TUNE1_ENABLE |
+                          (tune->minSQRun & PMW3360_LIFTCAL_TUNE1_MIN_SQ_RUN));
+
+    return;
+}
@@ -0,0 +1,150 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_LIFTCAL_H__
+#define PMW3360_LIFTCAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Bit 7 of LiftCutoff_Tune3 starts tuning and reads back set while tuning is in progress
+#define PMW3360_LIFTCAL_TUNE3_START                 0x80
+
+// Bit 7 of LiftCutoff_Tune1 enables the manual lift cutoff, bits 6:0 hold the tuned Min_SQ_Run
+#define PMW3360_LIFTCAL_TUNE1_ENABLE                0x80
+
+// Bits of LiftCutoff_Tune1 holding the tuned Min_SQ_Run
+#define PMW3360_LIFTCAL_TUNE1_MIN_SQ_RUN            0x7f
+
+// Number of step calls between polls of the tuning status
+#ifndef PMW3360_LIFTCAL_POLL_INTERVAL
+#define PMW3360_LIFTCAL_POLL_INTERVAL               8
+#endif
+
+/**
+ * @brief Status of the lift cutoff calibration
+ */
+typedef enum PMW3360_liftCalStatus
+{
+    PMW3360_LIFTCAL_IDLE = 0,   /**< Not started */
+    PMW3360_LIFTCAL_RUNNING,    /**< In progress, keep calling PMW3360_liftCal_step */
+    PMW3360_LIFTCAL_DONE,       /**< Finished, tune values are applied and can be saved */
+    PMW3360_LIFTCAL_TIMEOUT,    /**< Sensor did not finish tuning within the step budget, earlier tune values are back */
+    PMW3360_LIFTCAL_FAILED      /**< Sensor finished but reported unusable tune values, earlier tune values are back */
+} PMW3360_liftCalStatus;
+
+/**
+ * @brief Lift cutoff tune values, saved after calibration and restored at startup
+ */
+typedef struct PMW3360_liftTune
+{
+    uint8_t liftConfig;         /**< Lift_Config register */
+    uint8_t minSQRun;           /**< Min_SQ_Run register */
+    uint8_t rawDataThreshold;   /**< Raw_Data_Threshold register */
+} PMW3360_liftTune;
+
+/**
+ * @brief Resumable lift cutoff calibration state
+ */
+typedef struct PMW3360_liftCal
+{
+    uint8_t status;             /**< One of PMW3360_liftCalStatus */
+    uint8_t state;              /**< Next action of the state machine */
+    uint8_t timeout;            /**< LiftCutoff_Tune_Timeout value */
+    uint8_t minLength;          /**< LiftCutoff_Tune_Min_Length value */
+    uint8_t wait;               /**< Step calls left until the next status poll */
+    uint16_t polls;             /**< Status polls made so far */
+    uint16_t maxPolls;          /**< Status polls allowed before giving up */
+    uint8_t savedTune1;         /**< LiftCutoff_Tune1 before the calibration */
+    uint8_t savedTune2;         /**< LiftCutoff_Tune2 before the calibration */
+    uint8_t outcome;            /**< Status reported once the saved values are back */
+    PMW3360_liftTune tune;      /**< Tune values read back from the sensor */
+} PMW3360_liftCal;
+
+/**
+ * @brief Start a lift cutoff calibration.
+ *
+ * No bus traffic happens here, the work is done by PMW3360_liftCal_step.
+ * The sensor must be moved across the surface while calibration runs.
+ *
+ * @param cal Pointer to the calibration state.
+ * @param timeout Value for the LiftCutoff_Tune_Timeout register.
+ * @param minLength Value for the LiftCutoff_Tune_Min_Length register.
+ * @param maxPolls Status polls allowed before the calibration times out.
+ * @return none
+ */
+void PMW3360_liftCal_start(PMW3360_liftCal *cal, uint8_t timeout, uint8_t minLength, uint16_t maxPolls);
+
+/**
+ * @brief Advance the calibration by at most one register access.
+ *
+ * Call between PMW3360_read calls, each call adds at most one register
+ * access to the sample period so motion reporting continues. On a timeout
+ * or failure the calibration stays running for the few steps it takes to
+ * write back LiftCutoff_Tune1 and LiftCutoff_Tune2 as they were at start.
+ *
+ * @param cal Pointer to the calibration state.
+ * @return Current status
+ */
+PMW3360_liftCalStatus PMW3360_liftCal_step(PMW3360_liftCal *cal);
+
+/**
+ * @brief Abort a running calibration and stop tuning on the sensor.
+ *
+ * Writes back LiftCutoff_Tune1 and LiftCutoff_Tune2 as they were at start,
+ * so an earlier calibration stays in effect. Takes up to three register writes.
+ *
+ * @param cal Pointer to the calibration state.
+ * @return none
+ */
+void PMW3360_liftCal_abort(PMW3360_liftCal *cal);
+
+/**
+ * @brief Get the calibration progress.
+ *
+ * @param cal Pointer to the calibration state.
+ * @return Progress in percent
+ */
+uint8_t PMW3360_liftCal_progress(const PMW3360_liftCal *cal);
+
+/**
+ * @brief Copy the tune values of a finished calibration.
+ *
+ * @param cal Pointer to the calibration state.
+ * @param tune Pointer to PMW3360_liftTune structure to copy into.
+ * @return False if the calibration has not finished successfully
+ */
+bool PMW3360_liftCal_save(const PMW3360_liftCal *cal, PMW3360_liftTune *tune);
+
+/**
+ * @brief Apply previously saved tune values to the sensor.
+ *
+ * Writes Lift_Config, the threshold to LiftCutoff_Tune2 and the minimum
+ * SQUAL with the enable bit to LiftCutoff_Tune1, like a finished calibration.
+ *
+ * @param tune Tune values to apply.
+ * @return none
+ */
+void PMW3360_liftCal_restore(const PMW3360_liftTune *tune);
+
+#endif //PMW3360_LIFTCAL_H__
@@ -0,0 +1,220 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "PMW3360.h"
+#include "PMW3360_pipeline.h"
+
+#if (PMW3360_PIPELINE_SIZE & (PMW3360_PIPELINE_SIZE - 1)) != 0
+#error "PMW3360_PIPELINE_SIZE must be a power of two"
+#endif
+
+#if (PMW3360_PIPELINE_COMMANDS & (PMW3360_PIPELINE_COMMANDS - 1)) != 0
+#error "PMW3360_PIPELINE_COMMANDS must be a power of two"
+#endif
+
+/*
+ * Take as much of an accumulated displacement as fits a sample, leaving the rest.
+ */
+static int16_t PMW3360_pipeline_take(int32_t *pending)
+{
+    int32_t value = *pending < INT16_MIN ? INT16_MIN : (*pending > INT16_MAX ? INT16_MAX : *pending);
+
+    *pending -= value;
+
+    return (int16_t)value;
+}
+
+/*
+ * Initialize the pipeline, call before starting either thread.
+ */
+void PMW3360_pipeline_init(PMW3360_pipeline *pipeline, uint32_t period)
+{
+    atomic_init(&pipeline->sampleHead, 0);
+    atomic_init(&pipeline->sampleTail, 0);
+    atomic_init(&pipeline->commandHead, 0);
+    atomic_init(&pipeline->commandTail, 0);
+    atomic_init(&pipeline->overruns, 0);
+    atomic_init(&pipeline->readErrors, 0);
+    atomic_init(&pipeline->state, PMW3360_PIPELINE_STARTING);
+    pipeline->hasPending = false;
+    pipeline->pendingX = 0;
+    pipeline->pendingY = 0;
+    pipeline->period = period;
+
+    return;
+}
+
+/*
+ * Initialize the sensor from the sensor thread and publish the result.
+ */
+bool PMW3360_pipeline_start(PMW3360_pipeline *pipeline)
+{
+    bool result = PMW3360_init();
+
+    atomic_store_explicit(&pipeline->state, result ? PMW3360_PIPELINE_RUNNING : PMW3360_PIPELINE_FAILED,
+                          memory_order_release);
+
+    return result;
+}
+
+/*
+ * Run one iteration of the sensor thread.
+ */
+uint32_t PMW3360_pipeline_step(PMW3360_pipeline *pipeline, uint32_t timestamp)
+{
+    unsigned head = atomic_load_explicit(&pipeline->commandHead, memory_order_acquire);
+    unsigned tail = atomic_load_explicit(&pipeline->commandTail, memory_order_relaxed);
+    PMW3360_command *command;
+    PMW3360_data data;
+
+    // Apply commands from the consumer, the sensor is only touched from this thread
+    while (tail != head) {
+        command = &pipeline->commands[tail & (PMW3360_PIPELINE_COMMANDS - 1)];
+        if (command->type == PMW3360_PIPELINE_CMD_DPI) {
+            PMW3360_setDPI(command->value);
+        }
+        else if (command->type == PMW3360_PIPELINE_CMD_PERIOD) {
+            pipeline->period = command->value;
+        }
+        tail++;
+    }
+    atomic_store_explicit(&pipeline->commandTail, tail, memory_order_release);
+
+    // Read one sample and hand it to the consumer, a failed read has nothing worth pushing
+    if (PMW3360_read(&data)) {
+        PMW3360_pipeline_push(pipeline, &data, timestamp);
+    }
+    else {
+        atomic_store_explicit(&pipeline->readErrors,
+                              atomic_load_explicit(&pipeline->readErrors, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+    }
+
+    return pipeline->period;
+}
+
+/*
+ * Push a sample from the sensor thread.
+ */
+bool PMW3360_pipeline_push(PMW3360_pipeline *pipeline, const PMW3360_data *data, uint32_t timestamp)
+{
+    unsigned head = atomic_load_explicit(&pipeline->sampleHead, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&pipeline->sampleTail, memory_order_acquire);
+    PMW3360_sample *sample = &pipeline->pending;
+
+    // Fold the new sample into any motion held back from earlier overruns, in 32 bits so none is clipped
+    if (pipeline->hasPending) {
+        pipeline->pendingX += data->dx;
+        pipeline->pendingY += data->dy;
+        sample->data.motion = sample->data.motion || data->motion;
+        sample->data.surface = data->surface;
+#if PMW3360_ENABLE_DIAGNOSTICS
+        sample->data.SQUAL = data->SQUAL;
+        sample->data.rawDataSum = data->rawDataSum;
+        sample->data.maxRawData = data->maxRawData;
+        sample->data.minRawData = data->minRawData;
+        sample->data.shutter = data->shutter;
+#endif
+    }
+    else {
+        sample->data = *data;
+        pipeline->pendingX = data->dx;
+        pipeline->pendingY = data->dy;
+    }
+    sample->timestamp = timestamp;
+
+    // Hold the motion back when the consumer has not freed a slot
+    if (head - tail >= PMW3360_PIPELINE_SIZE) {
+        pipeline->hasPending = true;
+        atomic_store_explicit(&pipeline->overruns,
+                              atomic_load_explicit(&pipeline->overruns, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return false;
+    }
+
+    // Publish the sample, motion beyond its 16-bit range stays pending for the next one
+    sample->data.dx = PMW3360_pipeline_take(&pipeline->pendingX);
+    sample->data.dy = PMW3360_pipeline_take(&pipeline->pendingY);
+    pipeline->samples[head & (PMW3360_PIPELINE_SIZE - 1)] = *sample;
+    pipeline->hasPending = pipeline->pendingX != 0 || pipeline->pendingY != 0;
+    atomic_store_explicit(&pipeline->sampleHead, head + 1, memory_order_release);
+
+    return true;
+}
+
+/*
+ * Pop the oldest sample on the consumer thread.
+ */
+bool PMW3360_pipeline_pop(PMW3360_pipeline *pipeline, PMW3360_sample *sample)
+{
+    unsigned head = atomic_load_explicit(&pipeline->sampleHead, memory_order_acquire);
+    unsigned tail = atomic_load_explicit(&pipeline->sampleTail, memory_order_relaxed);
+
+    if (head == tail) {
+        return false;
+    }
+    *sample = pipeline->samples[tail & (PMW3360_PIPELINE_SIZE - 1)];
+    atomic_store_explicit(&pipeline->sampleTail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+/*
+ * Send a command to the sensor thread from the consumer thread.
+ */
+bool PMW3360_pipeline_command(PMW3360_pipeline *pipeline, uint8_t type, uint16_t value)
+{
+    unsigned head = atomic_load_explicit(&pipeline->commandHead, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&pipeline->commandTail, memory_order_acquire);
+    PMW3360_command *command;
+
+    if (head - tail >= PMW3360_PIPELINE_COMMANDS) {
+        return false;
+    }
+    command = &pipeline->commands[head & (PMW3360_PIPELINE_COMMANDS - 1)];
+    command->type = type;
+    command->value = value;
+    atomic_store_explicit(&pipeline->commandHead, head + 1, memory_order_release);
+
+    return true;
+}
+
+/*
+ * Get the number of samples coalesced because the consumer fell behind.
+ */
+uint32_t PMW3360_pipeline_overruns(PMW3360_pipeline *pipeline)
+{
+    return atomic_load_explicit(&pipeline->overruns, memory_order_relaxed);
+}
+
+/*
+ * Get the number of sensor reads that failed.
+ */
+uint32_t PMW3360_pipeline_readErrors(PMW3360_pipeline *pipeline)
+{
+    return atomic_load_explicit(&pipeline->readErrors, memory_order_relaxed);
+}
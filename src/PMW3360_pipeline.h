@@ -0,0 +1,168 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_PIPELINE_H__
+#define PMW3360_PIPELINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "PMW3360.h"
+
+// Number of samples buffered between the sensor and consumer threads, must be a power of two
+#ifndef PMW3360_PIPELINE_SIZE
+#define PMW3360_PIPELINE_SIZE                       16
+#endif
+
+// Number of commands buffered from the consumer to the sensor thread, must be a power of two
+#ifndef PMW3360_PIPELINE_COMMANDS
+#define PMW3360_PIPELINE_COMMANDS                   4
+#endif
+
+// Commands sent to the sensor thread
+#define PMW3360_PIPELINE_CMD_DPI                    0x01    /**< Set the DPI, value is the DPI */
+#define PMW3360_PIPELINE_CMD_PERIOD                 0x02    /**< Set the sample period, value in microseconds */
+
+// Sensor thread states
+#define PMW3360_PIPELINE_STARTING                   0
+#define PMW3360_PIPELINE_RUNNING                    1
+#define PMW3360_PIPELINE_FAILED                     2
+
+/**
+ * @brief One sample passed from the sensor thread to the consumer
+ */
+typedef struct PMW3360_sample
+{
+    PMW3360_data data;      /**< Motion data, dx and dy include any coalesced samples */
+    uint32_t timestamp;     /**< Time the sample was read in microseconds */
+} PMW3360_sample;
+
+/**
+ * @brief Command passed from the consumer to the sensor thread
+ */
+typedef struct PMW3360_command
+{
+    uint8_t type;           /**< One of PMW3360_PIPELINE_CMD_* */
+    uint16_t value;         /**< Command argument */
+} PMW3360_command;
+
+/**
+ * @brief Lock-free single producer, single consumer pipeline between two cores or threads
+ */
+typedef struct PMW3360_pipeline
+{
+    PMW3360_sample samples[PMW3360_PIPELINE_SIZE];      /**< Sample ring */
+    PMW3360_command commands[PMW3360_PIPELINE_COMMANDS];/**< Command ring */
+    atomic_uint sampleHead;                             /**< Next sample slot written by the sensor thread */
+    atomic_uint sampleTail;                             /**< Next sample slot read by the consumer */
+    atomic_uint commandHead;                            /**< Next command slot written by the consumer */
+    atomic_uint commandTail;                            /**< Next command slot read by the sensor thread */
+    atomic_uint overruns;                               /**< Samples coalesced because the ring was full */
+    atomic_uint readErrors;                             /**< Reads that failed and pushed nothing */
+    atomic_uint state;                                  /**< One of PMW3360_PIPELINE_STARTING/RUNNING/FAILED */
+    PMW3360_sample pending;                             /**< Sample held back while the ring is full, sensor thread only */
+    int32_t pendingX;                                   /**< Held back x motion, may exceed 16 bits, sensor thread only */
+    int32_t pendingY;                                   /**< Held back y motion, may exceed 16 bits, sensor thread only */
+    bool hasPending;                                    /**< True when pending holds motion, sensor thread only */
+    uint32_t period;                                    /**< Sample period in microseconds, sensor thread only */
+} PMW3360_pipeline;
+
+/**
+ * @brief Initialize the pipeline, call before starting either thread.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param period Initial sample period in microseconds.
+ * @return none
+ */
+void PMW3360_pipeline_init(PMW3360_pipeline *pipeline, uint32_t period);
+
+/**
+ * @brief Initialize the sensor from the sensor thread and publish the result.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @return True if the sensor initialized
+ */
+bool PMW3360_pipeline_start(PMW3360_pipeline *pipeline);
+
+/**
+ * @brief Run one iteration of the sensor thread.
+ *
+ * Applies pending commands, reads one sample and pushes it. When the ring
+ * is full the motion is coalesced into the next sample and the overrun
+ * counter is incremented, so no displacement is lost. Coalesced motion
+ * beyond the 16-bit range of a sample is carried into the following ones.
+ * A read that fails pushes nothing and increments the read error counter.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param timestamp Current time in microseconds.
+ * @return Sample period in microseconds to wait before the next call
+ */
+uint32_t PMW3360_pipeline_step(PMW3360_pipeline *pipeline, uint32_t timestamp);
+
+/**
+ * @brief Push a sample from the sensor thread.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param data Sample to push.
+ * @param timestamp Time the sample was read in microseconds.
+ * @return False if the ring was full and the sample was coalesced
+ */
+bool PMW3360_pipeline_push(PMW3360_pipeline *pipeline, const PMW3360_data *data, uint32_t timestamp);
+
+/**
+ * @brief Pop the oldest sample on the consumer thread.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param sample Pointer to PMW3360_sample structure to copy into.
+ * @return False if no sample is available
+ */
+bool PMW3360_pipeline_pop(PMW3360_pipeline *pipeline, PMW3360_sample *sample);
+
+/**
+ * @brief Send a command to the sensor thread from the consumer thread.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @param type One of PMW3360_PIPELINE_CMD_*.
+ * @param value Command argument.
+ * @return False if the command ring is full
+ */
+bool PMW3360_pipeline_command(PMW3360_pipeline *pipeline, uint8_t type, uint16_t value);
+
+/**
+ * @brief Get the number of samples coalesced because the consumer fell behind.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @return Overrun count
+ */
+uint32_t PMW3360_pipeline_overruns(PMW3360_pipeline *pipeline);
+
+/**
+ * @brief Get the number of sensor reads that failed.
+ *
+ * @param pipeline Pointer to the pipeline.
+ * @return Read error count
+ */
+uint32_t PMW3360_pipeline_readErrors(PMW3360_pipeline *pipeline);
+
+#endif //PMW3360_PIPELINE_H__
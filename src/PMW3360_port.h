@@ -24,8 +24,39 @@
 #ifndef PMW3360_PORT_H__
 #define PMW3360_PORT_H__
 
+// The port keeps its bus state in static variables, one copy per translation unit
+#if !defined(PMW3360_PORT_IMPLEMENTATION)
+#error "PMW3360_port.h is private to PMW3360.c"
+#endif
+
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+// Flags of a PMW3360_transfer
+#define PMW3360_XFER_CS_CHANGE      0x01    // Release chip select after this transfer
+#define PMW3360_XFER_BYTE_DELAY     0x02    // Apply the delay after every byte instead of once
+
+/*
+ * One segment of an SPI transaction. A list of transfers runs with chip
+ * select held low, the delay follows the data before chip select changes.
+ * PMW3360_SPI_init and PMW3360_SPI_transfer return false on a bus error.
+ */
+typedef struct PMW3360_transfer
+{
+    const uint8_t *tx;      // Bytes to send, NULL sends zeros
+    uint8_t *rx;            // Buffer for received bytes, NULL discards them
+    uint16_t length;        // Number of bytes
+    uint16_t delay;         // Delay in microseconds
+    uint8_t flags;          // PMW3360_XFER_* flags
+} PMW3360_transfer;
+
+// Port functions with many call sites, kept out of line in size optimized builds
+#if PMW3360_SIZE_OPTIMIZED && defined(__GNUC__)
+#define PMW3360_PORT_SHARED         static __attribute__((noinline, unused))
+#else
+#define PMW3360_PORT_SHARED         static inline
+#endif
 
 #if defined(__PICO_SDK__)
 
@@ -34,20 +65,29 @@
 #include "hardware/resets.h"
 
 #define PMW3360_delayMicroseconds(x)    (sleep_us(x))
+#define PMW3360_micros()                (time_us_32())  // Optional, lets caller work overlap register delays
 
 #define PIN_SCK     18
 #define PIN_MOSI    19
 #define PIN_MISO    20
 #define PIN_CS      21
+#define PIN_CS2     17
 
 #define SPI_PORT    spi0
 
-static inline void PMW3360_SPI_init()
+static uint PMW3360_SPI_cs = PIN_CS;
+
+static inline bool PMW3360_SPI_init()
 {
-    // Configure chip select pin
+    // Configure chip select pins
     gpio_init(PIN_CS);
     gpio_set_dir(PIN_CS, GPIO_OUT);
     gpio_put(PIN_CS, 1);
+#if PMW3360_SENSOR_COUNT > 1
+    gpio_init(PIN_CS2);
+    gpio_set_dir(PIN_CS2, GPIO_OUT);
+    gpio_put(PIN_CS2, 1);
+#endif
 
     // Configure SPI for 1MHz
     spi_init(SPI_PORT, 1000000);
@@ -59,6 +99,8 @@ static inline void PMW3360_SPI_init()
     // Send dummy byte without chip selected to fix clock polarity
     uint8_t data = 0;
     spi_write_blocking(SPI_PORT, &data, 1);
+
+    return true;
 }
 
 static inline void PMW3360_SPI_shutdown()
@@ -67,10 +109,16 @@ static inline void PMW3360_SPI_shutdown()
     spi_deinit(SPI_PORT);
 }
 
+static inline void PMW3360_SPI_select(uint8_t sensor)
+{
+    // Choose the chip select pin used by the following transfers
+    PMW3360_SPI_cs = sensor ? PIN_CS2 : PIN_CS;
+}
+
 static inline void PMW3360_SPI_begin(void)
 {
     // Set chip select pin low
-    gpio_put(PIN_CS, 0);
+    gpio_put(PMW3360_SPI_cs, 0);
     PMW3360_delayMicroseconds(1);
 }
 
@@ -78,10 +126,10 @@ static inline void PMW3360_SPI_end(void)
 {
     // Set chip select pin high
     PMW3360_delayMicroseconds(1);
-    gpio_put(PIN_CS, 1);
+    gpio_put(PMW3360_SPI_cs, 1);
 }
 
-static inline uint8_t PMW3360_SPI_readWrite(uint8_t data)
+PMW3360_PORT_SHARED uint8_t PMW3360_SPI_readWrite(uint8_t data)
 {
     uint8_t result;
 
@@ -97,12 +145,22 @@ static inline uint8_t PMW3360_SPI_readWrite(uint8_t data)
 #include <msp430.h>
 
 #define PMW3360_delayMicroseconds(x)    (__delay_cycles(x<<3))  // MCLK @ 8MHz
+#define PMW3360_DELAY_CONSTANT_ONLY                             // __delay_cycles needs a compile-time constant
 
-static inline void PMW3360_SPI_init()
+#define CS_BIT      BIT3    // P5.3
+#define CS2_BIT     BIT4    // P5.4
+
+static uint8_t PMW3360_SPI_cs = CS_BIT;
+
+static inline bool PMW3360_SPI_init()
 {
-    // Configure chip select pin
-    P5OUT &= ~BIT3;
-    P5DIR |= BIT3;
+    // Configure chip select pins
+    P5OUT |= CS_BIT;
+    P5DIR |= CS_BIT;
+#if PMW3360_SENSOR_COUNT > 1
+    P5OUT |= CS2_BIT;
+    P5DIR |= CS2_BIT;
+#endif
 
     // Configure CLK, MOSI and MISO pins
     P5SEL1 &= ~(BIT0 | BIT1 | BIT2);
@@ -114,6 +172,8 @@ static inline void PMW3360_SPI_init()
     UCB1CTLW0 |= UCSSEL__SMCLK;
     UCB1BRW = 0x08;
     UCB1CTLW0 &= ~UCSWRST;
+
+    return true;
 }
 
 static inline void PMW3360_SPI_shutdown()
@@ -122,10 +182,16 @@ static inline void PMW3360_SPI_shutdown()
     UCB1CTLW0 = UCSWRST;
 }
 
+static inline void PMW3360_SPI_select(uint8_t sensor)
+{
+    // Choose the chip select pin used by the following transfers
+    PMW3360_SPI_cs = sensor ? CS2_BIT : CS_BIT;
+}
+
 static inline void PMW3360_SPI_begin(void)
 {
     // Set chip select pin low
-    P5OUT &= ~BIT3;
+    P5OUT &= ~PMW3360_SPI_cs;
     PMW3360_delayMicroseconds(1);
 }
 
@@ -133,10 +199,10 @@ static inline void PMW3360_SPI_end(void)
 {
     // Set chip select pin high
     PMW3360_delayMicroseconds(1);
-    P5OUT |= BIT3;
+    P5OUT |= PMW3360_SPI_cs;
 }
 
-static inline uint8_t PMW3360_SPI_readWrite(uint8_t data)
+PMW3360_PORT_SHARED uint8_t PMW3360_SPI_readWrite(uint8_t data)
 {
     // Wait for transmit buffer to clear and transmit data byte
     while(!(UCB1IFG & UCTXIFG));
@@ -150,6 +216,260 @@ static inline uint8_t PMW3360_SPI_readWrite(uint8_t data)
     return data;
 }
 
+#elif defined(__linux__)
+
+// clock_gettime and struct timespec are POSIX, a strict C build hides them otherwise.
+// Only effective before the first system header, PMW3360.c defines it first thing
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+#ifndef PMW3360_SPIDEV_PATH
+#define PMW3360_SPIDEV_PATH         "/dev/spidev0.0"
+#endif
+
+#ifndef PMW3360_SPIDEV_PATH2
+#define PMW3360_SPIDEV_PATH2        "/dev/spidev0.1"
+#endif
+
+#ifndef PMW3360_SPIDEV_SPEED
+#define PMW3360_SPIDEV_SPEED        2000000
+#endif
+
+// System calls used by the port, define these to stand-in functions (declared via a forced
+// include) to run the driver without hardware
+#ifndef PMW3360_SPIDEV_OPEN
+#define PMW3360_SPIDEV_OPEN         open
+#endif
+#ifndef PMW3360_SPIDEV_CLOSE
+#define PMW3360_SPIDEV_CLOSE        close
+#endif
+#ifndef PMW3360_SPIDEV_IOCTL
+#define PMW3360_SPIDEV_IOCTL        ioctl
+#endif
+#ifndef PMW3360_SPIDEV_CLOCK_GETTIME
+#define PMW3360_SPIDEV_CLOCK_GETTIME    clock_gettime
+#endif
+
+// Transfers per SPI_IOC_MESSAGE, bounded by the ioctl size field
+#define PMW3360_SPIDEV_BATCH        511
+
+// The port runs whole transactions instead of single bytes
+#define PMW3360_PORT_HAS_TRANSFER
+
+static int PMW3360_SPIDEV_fd[2] = { -1, -1 };
+static uint8_t PMW3360_SPIDEV_cs = 0;
+static struct spi_ioc_transfer PMW3360_SPIDEV_batch[PMW3360_SPIDEV_BATCH];
+
+static inline uint32_t PMW3360_SPIDEV_micros(void)
+{
+    struct timespec now;
+
+    PMW3360_SPIDEV_CLOCK_GETTIME(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec*1000000 + now.tv_nsec/1000);
+}
+
+static inline void PMW3360_SPIDEV_delay(uint32_t us)
+{
+    uint32_t start = PMW3360_SPIDEV_micros();
+
+    // Busy wait, the scheduler can not sleep for the short delays the sensor needs.
+    // The first tick may come right after start, so wait for one more to cover the whole delay
+    while (PMW3360_SPIDEV_micros() - start <= us);
+}
+
+#define PMW3360_delayMicroseconds(x)    (PMW3360_SPIDEV_delay(x))
+#define PMW3360_micros()                (PMW3360_SPIDEV_micros())
+
+static inline bool PMW3360_SPIDEV_open(uint8_t index, const char *path)
+{
+    uint8_t mode = SPI_MODE_3;
+    uint8_t bits = 8;
+    uint32_t speed = PMW3360_SPIDEV_SPEED;
+    int fd;
+
+    if (PMW3360_SPIDEV_fd[index] >= 0) {
+        return true;
+    }
+
+    // Open the device and configure mode 3, 8-bit words, the driver handles clock polarity
+    fd = PMW3360_SPIDEV_OPEN(path, O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+    if (PMW3360_SPIDEV_IOCTL(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+        PMW3360_SPIDEV_IOCTL(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        PMW3360_SPIDEV_IOCTL(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+        PMW3360_SPIDEV_CLOSE(fd);
+        return false;
+    }
+    PMW3360_SPIDEV_fd[index] = fd;
+
+    return true;
+}
+
+static inline bool PMW3360_SPI_init()
+{
+    bool result = PMW3360_SPIDEV_open(0, PMW3360_SPIDEV_PATH);
+
+#if PMW3360_SENSOR_COUNT > 1
+    result = PMW3360_SPIDEV_open(1, PMW3360_SPIDEV_PATH2) && result;
+#endif
+
+    return result;
+}
+
+static inline void PMW3360_SPI_shutdown()
+{
+    uint8_t i;
+
+    // Close every open device
+    for (i = 0; i < 2; i++) {
+        if (PMW3360_SPIDEV_fd[i] >= 0) {
+            PMW3360_SPIDEV_CLOSE(PMW3360_SPIDEV_fd[i]);
+            PMW3360_SPIDEV_fd[i] = -1;
+        }
+    }
+}
+
+static inline void PMW3360_SPI_select(uint8_t sensor)
+{
+    // Each sensor has its own spidev chip select
+    PMW3360_SPIDEV_cs = sensor ? 1 : 0;
+}
+
+PMW3360_PORT_SHARED bool PMW3360_SPI_transfer(const PMW3360_transfer *xfer, uint8_t count)
+{
+    int fd = PMW3360_SPIDEV_fd[PMW3360_SPIDEV_cs];
+    uint16_t n = 0;
+    uint16_t j;
+    uint8_t i;
+    struct spi_ioc_transfer *t;
+
+    if (fd < 0) {
+        return false;
+    }
+
+    // Build the whole transaction as one message, splitting only when the batch fills up
+    for (i = 0; i < count; i++) {
+        for (j = 0; j < xfer[i].length; ) {
+            // One entry per byte when each byte needs its own delay, otherwise one for all bytes
+            t = &PMW3360_SPIDEV_batch[n++];
+            memset(t, 0, sizeof(*t));
+            if (xfer[i].flags & PMW3360_XFER_BYTE_DELAY) {
+                t->len = 1;
+            }
+            else {
+                t->len = xfer[i].length;
+            }
+            t->tx_buf = xfer[i].tx ? (uintptr_t)(xfer[i].tx + j) : 0;
+            t->rx_buf = xfer[i].rx ? (uintptr_t)(xfer[i].rx + j) : 0;
+            t->delay_usecs = (xfer[i].flags & PMW3360_XFER_BYTE_DELAY) || j + t->len == xfer[i].length ?
+                             xfer[i].delay : 0;
+            j += t->len;
+
+            // Release chip select between transfers that ask for it
+            if (j == xfer[i].length && (xfer[i].flags & PMW3360_XFER_CS_CHANGE) && i + 1 < count) {
+                t->cs_change = 1;
+            }
+
+            // Send a full batch, on the last entry cs_change keeps chip select asserted instead
+            if (n == PMW3360_SPIDEV_BATCH && (i + 1 < count || j < xfer[i].length)) {
+                t->cs_change = !t->cs_change;
+                if (PMW3360_SPIDEV_IOCTL(fd, SPI_IOC_MESSAGE(n), PMW3360_SPIDEV_batch) < 0) {
+                    return false;
+                }
+                n = 0;
+            }
+        }
+    }
+
+    if (n > 0 && PMW3360_SPIDEV_IOCTL(fd, SPI_IOC_MESSAGE(n), PMW3360_SPIDEV_batch) < 0) {
+        return false;
+    }
+
+    return true;
+}
+
+#endif
+
+#if defined(PMW3360_DELAY_CONSTANT_ONLY)
+/*
+ * Delay for a run-time number of microseconds using only constant delays,
+ * for ports that can only delay by compile-time constants.
+ */
+PMW3360_PORT_SHARED void PMW3360_delayVariable(uint32_t us)
+{
+    while (us >= 1000) {
+        PMW3360_delayMicroseconds(1000);
+        us -= 1000;
+    }
+    while (us >= 100) {
+        PMW3360_delayMicroseconds(100);
+        us -= 100;
+    }
+    while (us >= 10) {
+        PMW3360_delayMicroseconds(10);
+        us -= 10;
+    }
+    while (us > 0) {
+        PMW3360_delayMicroseconds(1);
+        us--;
+    }
+}
+#else
+/*
+ * Delay for a run-time number of microseconds.
+ */
+PMW3360_PORT_SHARED void PMW3360_delayVariable(uint32_t us)
+{
+    PMW3360_delayMicroseconds(us);
+}
+#endif
+
+#if !defined(PMW3360_PORT_HAS_TRANSFER)
+/*
+ * Run a list of transfers one byte at a time using the port's byte primitives,
+ * which have no way to report a bus error.
+ */
+PMW3360_PORT_SHARED bool PMW3360_SPI_transfer(const PMW3360_transfer *xfer, uint8_t count)
+{
+    uint8_t i;
+    uint16_t j;
+    uint8_t data;
+
+    PMW3360_SPI_begin();
+    for (i = 0; i < count; i++) {
+        for (j = 0; j < xfer[i].length; j++) {
+            data = PMW3360_SPI_readWrite(xfer[i].tx ? xfer[i].tx[j] : 0);
+            if (xfer[i].rx) {
+                xfer[i].rx[j] = data;
+            }
+            if (xfer[i].flags & PMW3360_XFER_BYTE_DELAY) {
+                PMW3360_delayVariable(xfer[i].delay);
+            }
+        }
+        if (!(xfer[i].flags & PMW3360_XFER_BYTE_DELAY)) {
+            PMW3360_delayVariable(xfer[i].delay);
+        }
+
+        // Toggle chip select between transfers that ask for it
+        if ((xfer[i].flags & PMW3360_XFER_CS_CHANGE) && i + 1 < count) {
+            PMW3360_SPI_end();
+            PMW3360_SPI_begin();
+        }
+    }
+    PMW3360_SPI_end();
+
+    return true;
+}
 #endif
 
 #endif //PMW3360_PORT_H__
@@ -0,0 +1,74 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_profile.h"
+
+/*
+ * Apply a profile to the selected sensor.
+ */
+bool PMW3360_profile_apply(const PMW3360_profile *profile, uint8_t flags)
+{
+    PMW3360_regValue table[14];
+    int16_t dpi;
+
+    // Same rounding and range as PMW3360_setDPI
+    dpi = (profile->dpi/100) - 1;
+    dpi = dpi < 0 ? 0 : (dpi < 0x77 ? dpi : 0x77);
+
+    table[0].address = PMW3360_REG_CONFIG1;
+    table[0].value = (uint8_t)dpi;
+    table[1].address = PMW3360_REG_ANGLE_TUNE;
+    table[1].value = (uint8_t)profile->angleTune;
+    table[2].address = PMW3360_REG_ANGLE_SNAP;
+    table[2].value = profile->angleSnap ? PMW3360_ANGLE_SNAP_EN : 0x00;
+    table[3].address = PMW3360_REG_LIFT_CONFIG;
+    table[3].value = profile->liftConfig;
+
+    // Rest timing is written before Config2 so rest mode never runs with stale values
+    table[4].address = PMW3360_REG_RUN_DOWNSHIFT;
+    table[4].value = profile->runDownshift;
+    table[5].address = PMW3360_REG_REST1_RATE_LOWER;
+    table[5].value = (uint8_t)profile->rest1Rate;
+    table[6].address = PMW3360_REG_REST1_RATE_UPPER;
+    table[6].value = (uint8_t)(profile->rest1Rate >> 8);
+    table[7].address = PMW3360_REG_REST1_DOWNSHIFT;
+    table[7].value = profile->rest1Downshift;
+    table[8].address = PMW3360_REG_REST2_RATE_LOWER;
+    table[8].value = (uint8_t)profile->rest2Rate;
+    table[9].address = PMW3360_REG_REST2_RATE_UPPER;
+    table[9].value = (uint8_t)(profile->rest2Rate >> 8);
+    table[10].address = PMW3360_REG_REST2_DOWNSHIFT;
+    table[10].value = profile->rest2Downshift;
+    table[11].address = PMW3360_REG_REST3_RATE_LOWER;
+    table[11].value = (uint8_t)profile->rest3Rate;
+    table[12].address = PMW3360_REG_REST3_RATE_UPPER;
+    table[12].value = (uint8_t)(profile->rest3Rate >> 8);
+    table[13].address = PMW3360_REG_CONFIG2;
+    table[13].value = profile->rest ? PMW3360_CONFIG2_REST_EN : 0x00;
+
+    return PMW3360_writeRegisters(table, sizeof(table)/sizeof(table[0]), flags);
+}
@@ -0,0 +1,66 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_PROFILE_H__
+#define PMW3360_PROFILE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+
+/**
+ * @brief Sensor configuration that can be switched as a whole at runtime
+ */
+typedef struct PMW3360_profile
+{
+    uint16_t dpi;               /**< Resolution, rounded down to multiples of 100 */
+    int8_t angleTune;           /**< Angle_Tune value, rotation in degrees */
+    bool angleSnap;             /**< Enable the hardware angle snap */
+    uint8_t liftConfig;         /**< Lift_Config value */
+    bool rest;                  /**< Enable the rest modes */
+    uint8_t runDownshift;       /**< Run_Downshift value */
+    uint16_t rest1Rate;         /**< Rest1_Rate value */
+    uint8_t rest1Downshift;     /**< Rest1_Downshift value */
+    uint16_t rest2Rate;         /**< Rest2_Rate value */
+    uint8_t rest2Downshift;     /**< Rest2_Downshift value */
+    uint16_t rest3Rate;         /**< Rest3_Rate value */
+} PMW3360_profile;
+
+// Profile matching the state left by PMW3360_init, with the sensor's power-up angle, lift and rest settings
+#define PMW3360_PROFILE_DEFAULT                     { 800, 0, false, 0x02, false, 0x32, 0x0000, 0x1f, 0x0063, 0xbc, 0x01f3 }
+
+/**
+ * @brief Apply a profile to the selected sensor.
+ *
+ * Only registers that differ from the current configuration are written,
+ * so switching between profiles that differ in one setting costs one
+ * register write.
+ *
+ * @param profile Profile to apply.
+ * @param flags PMW3360_WRITE_VERIFY and/or PMW3360_WRITE_FORCE.
+ * @return False if a read back value differs
+ */
+bool PMW3360_profile_apply(const PMW3360_profile *profile, uint8_t flags);
+
+#endif //PMW3360_PROFILE_H__
@@ -0,0 +1,322 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "PMW3360.h"
+#include "PMW3360_profile.h"
+#include "PMW3360_rest.h"
+
+// Power mode an idle gap ends in
+#define PMW3360_REST_RUN        0
+#define PMW3360_REST_REST1      1
+#define PMW3360_REST_REST2      2
+#define PMW3360_REST_REST3      3
+
+// Downshift register values tried, powers of two cover the range in a few steps at histogram resolution
+static const uint8_t PMW3360_restDownshifts[] = { 1, 2, 4, 8, 16, 32, 64, 128, 255 };
+
+/*
+ * Timing and current of the run and rest modes in milliseconds and microamps.
+ */
+typedef struct PMW3360_restTiming
+{
+    uint32_t limit[3];          // Time in run, Rest1 and Rest2 before moving to the next mode
+    uint32_t period[4];         // Frame period of each mode, the worst case wake latency
+    uint32_t current[4];        // Current drawn in each mode
+} PMW3360_restTiming;
+
+/*
+ * Convert a profile to mode timings, the downshift registers count in units of the mode period.
+ */
+static void PMW3360_rest_timing(const PMW3360_profile *profile, PMW3360_restTiming *timing)
+{
+    uint8_t mode;
+
+    timing->period[PMW3360_REST_RUN] = 0;
+    timing->period[PMW3360_REST_REST1] = (uint32_t)profile->rest1Rate + 1;
+    timing->period[PMW3360_REST_REST2] = (uint32_t)profile->rest2Rate + 1;
+    timing->period[PMW3360_REST_REST3] = (uint32_t)profile->rest3Rate + 1;
+    timing->limit[PMW3360_REST_RUN] = (uint32_t)profile->runDownshift*10;
+    timing->limit[PMW3360_REST_REST1] = (uint32_t)profile->rest1Downshift*320*timing->period[PMW3360_REST_REST1];
+    timing->limit[PMW3360_REST_REST2] = (uint32_t)profile->rest2Downshift*32*timing->period[PMW3360_REST_REST2];
+
+    // Rest modes draw a floor plus a charge per frame, divided out once per candidate instead of per bucket
+    timing->current[PMW3360_REST_RUN] = PMW3360_REST_RUN_CURRENT;
+    for (mode = PMW3360_REST_REST1; mode <= PMW3360_REST_REST3; mode++) {
+        timing->current[mode] = PMW3360_REST_FLOOR_CURRENT + PMW3360_REST_FRAME_CHARGE/timing->period[mode];
+    }
+
+    return;
+}
+
+/*
+ * Score a profile against the histogram snapshot, returns the modelled charge or UINT64_MAX if the latency bound is
+ * missed. Rest disabled keeps the sensor in run mode and always meets the bound.
+ */
+static uint64_t PMW3360_rest_score(const PMW3360_restScan *scan, uint16_t latency, const PMW3360_profile *profile)
+{
+    PMW3360_restTiming timing;
+    uint64_t charge = 0;
+    uint32_t slow = 0;
+    uint32_t left;
+    uint8_t k, mode;
+
+    if (!profile->rest) {
+        return UINT64_MAX - 1;
+    }
+    PMW3360_rest_timing(profile, &timing);
+
+    for (k = 0; k < PMW3360_REST_BUCKETS; k++) {
+        if (scan->count[k] == 0) {
+            continue;
+        }
+
+        // Walk the mean gap of the bucket down the modes, charging the time spent in each
+        left = scan->mean[k];
+        for (mode = PMW3360_REST_RUN; mode < PMW3360_REST_REST3 && left > timing.limit[mode]; mode++) {
+            charge += (uint64_t)timing.limit[mode]*timing.current[mode]*scan->count[k];
+            left -= timing.limit[mode];
+        }
+        charge += (uint64_t)left*timing.current[mode]*scan->count[k];
+
+        // Gaps ending in a mode slower than the bound count against the percentile
+        if (timing.period[mode] > latency) {
+            slow += scan->count[k];
+        }
+    }
+
+    if ((uint32_t)slow*100 > (uint32_t)scan->gaps*(100 - PMW3360_REST_PERCENTILE)) {
+        return UINT64_MAX;
+    }
+
+    return charge;
+}
+
+/*
+ * Start a search, the bucket means are divided out once here instead of for every candidate.
+ */
+static void PMW3360_rest_scanStart(const PMW3360_rest *rest, PMW3360_restScan *scan)
+{
+    uint8_t k;
+
+    for (k = 0; k < PMW3360_REST_BUCKETS; k++) {
+        scan->count[k] = rest->count[k];
+        scan->mean[k] = rest->count[k] ? rest->sum[k]/rest->count[k] : 0;
+    }
+    scan->gaps = rest->gaps;
+    scan->best = UINT64_MAX;
+    scan->chosen = rest->profile;
+    scan->rest1Rate = 0;
+    scan->runDownshift = 0;
+    scan->active = true;
+
+    return;
+}
+
+/*
+ * Score one row of candidates, every Rest1 downshift for the next run downshift and Rest1 rate.
+ * Returns true once the last row was scored.
+ */
+static bool PMW3360_rest_scanRow(const PMW3360_rest *rest, PMW3360_restScan *scan)
+{
+    PMW3360_profile candidate = rest->profile;
+    uint64_t score;
+    uint32_t period;
+    uint8_t j;
+
+    candidate.rest = true;
+    candidate.runDownshift = PMW3360_restDownshifts[scan->runDownshift];
+    candidate.rest1Rate = scan->rest1Rate;
+    for (j = 0; j < sizeof(PMW3360_restDownshifts); j++) {
+        candidate.rest1Downshift = PMW3360_restDownshifts[j];
+        score = PMW3360_rest_score(scan, rest->latency, &candidate);
+        if (score < scan->best) {
+            scan->best = score;
+            scan->chosen.rest = true;
+            scan->chosen.runDownshift = candidate.runDownshift;
+            scan->chosen.rest1Rate = candidate.rest1Rate;
+            scan->chosen.rest1Downshift = candidate.rest1Downshift;
+        }
+    }
+
+    // Rest1 periods double up to the Rest2 period, Rest1 slower than Rest2 saves nothing
+    period = ((uint32_t)scan->rest1Rate + 1)*2;
+    if (period <= (uint32_t)rest->profile.rest2Rate + 1) {
+        scan->rest1Rate = (uint16_t)(period - 1);
+        return false;
+    }
+    scan->rest1Rate = 0;
+    scan->runDownshift++;
+    scan->active = scan->runDownshift < sizeof(PMW3360_restDownshifts);
+
+    return !scan->active;
+}
+
+/*
+ * Copy the outcome of a finished search into a profile.
+ */
+static bool PMW3360_rest_scanResult(const PMW3360_restScan *scan, PMW3360_profile *profile)
+{
+    // Without a setting that meets the bound stay in run mode
+    if (scan->best == UINT64_MAX) {
+        profile->rest = false;
+        return false;
+    }
+    profile->rest = true;
+    profile->runDownshift = scan->chosen.runDownshift;
+    profile->rest1Rate = scan->chosen.rest1Rate;
+    profile->rest1Downshift = scan->chosen.rest1Downshift;
+
+    return true;
+}
+
+/*
+ * Write the settings the tuner owns, Config2 is read so its other bits survive.
+ */
+static void PMW3360_rest_apply(const PMW3360_profile *profile)
+{
+    PMW3360_regValue table[5];
+    uint8_t config2 = PMW3360_readRegister(PMW3360_REG_CONFIG2);
+
+    // Rest timing is written before Config2 so rest mode never runs with stale values
+    table[0].address = PMW3360_REG_RUN_DOWNSHIFT;
+    table[0].value = profile->runDownshift;
+    table[1].address = PMW3360_REG_REST1_RATE_LOWER;
+    table[1].value = (uint8_t)profile->rest1Rate;
+    table[2].address = PMW3360_REG_REST1_RATE_UPPER;
+    table[2].value = (uint8_t)(profile->rest1Rate >> 8);
+    table[3].address = PMW3360_REG_REST1_DOWNSHIFT;
+    table[3].value = profile->rest1Downshift;
+    table[4].address = PMW3360_REG_CONFIG2;
+    table[4].value = profile->rest ? (config2 | PMW3360_CONFIG2_REST_EN) : (config2 & ~PMW3360_CONFIG2_REST_EN);
+    PMW3360_writeRegisters(table, sizeof(table)/sizeof(table[0]), 0);
+
+    return;
+}
+
+/*
+ * Initialize the rest mode tuner.
+ */
+void PMW3360_rest_init(PMW3360_rest *rest, const PMW3360_profile *base, uint16_t latency, uint32_t interval)
+{
+    rest->profile = *base;
+    memset(rest->count, 0, sizeof(rest->count));
+    memset(rest->sum, 0, sizeof(rest->sum));
+    rest->gaps = 0;
+    rest->latency = latency;
+    rest->interval = interval;
+    rest->lastMotion = 0;
+    rest->lastTuning = 0;
+    rest->started = false;
+    rest->idle = false;
+    rest->scan.active = false;
+
+    return;
+}
+
+/*
+ * Choose the rest settings for the idle gaps seen so far.
+ */
+bool PMW3360_rest_choose(const PMW3360_rest *rest, PMW3360_profile *profile)
+{
+    PMW3360_restScan scan;
+
+    PMW3360_rest_scanStart(rest, &scan);
+    while (!PMW3360_rest_scanRow(rest, &scan)) {
+    }
+
+    return PMW3360_rest_scanResult(&scan, profile);
+}
+
+/*
+ * Record one sample and retune the rest modes when due.
+ */
+bool PMW3360_rest_update(PMW3360_rest *rest, const PMW3360_data *data, uint32_t timestamp)
+{
+    PMW3360_profile chosen;
+    uint64_t current;
+    uint32_t gap;
+    uint8_t k;
+
+    if (data->motion) {
+        // Close the idle gap and file it under its power of two bucket
+        if (rest->idle) {
+            gap = timestamp - rest->lastMotion;
+            k = 0;
+            while (k < PMW3360_REST_BUCKETS - 1 && (gap >> (k + 1)) != 0) {
+                k++;
+            }
+            rest->count[k]++;
+            rest->sum[k] += gap;
+            rest->gaps++;
+
+            // Halve the history so the tuner follows changes in usage
+            if (rest->gaps >= PMW3360_REST_HISTORY) {
+                rest->gaps = 0;
+                for (k = 0; k < PMW3360_REST_BUCKETS; k++) {
+                    rest->count[k] /= 2;
+                    rest->sum[k] = rest->count[k] ? rest->sum[k]/2 : 0;
+                    rest->gaps += rest->count[k];
+                }
+            }
+        }
+        rest->started = true;
+        rest->idle = false;
+        rest->lastMotion = timestamp;
+    }
+    else {
+        // A gap only opens after motion, otherwise it would be timed from zero
+        rest->idle = rest->started;
+    }
+
+    // Start a search when due, rate limited since every search scores every candidate
+    if (!rest->scan.active) {
+        if (rest->gaps < PMW3360_REST_MIN_GAPS || timestamp - rest->lastTuning < rest->interval) {
+            return false;
+        }
+        rest->lastTuning = timestamp;
+        PMW3360_rest_scanStart(rest, &rest->scan);
+    }
+
+    // One row of candidates per sample, so no single call pays for the whole search
+    if (!PMW3360_rest_scanRow(rest, &rest->scan)) {
+        return false;
+    }
+
+    // Keep the current settings unless they miss the bound or the new ones save a worthwhile share
+    chosen = rest->profile;
+    PMW3360_rest_scanResult(&rest->scan, &chosen);
+    current = PMW3360_rest_score(&rest->scan, rest->latency, &rest->profile);
+    if (current != UINT64_MAX &&
+        PMW3360_rest_score(&rest->scan, rest->latency, &chosen) >= current - (current >> PMW3360_REST_MARGIN)) {
+        return false;
+    }
+
+    rest->profile = chosen;
+    PMW3360_rest_apply(&rest->profile);
+
+    return true;
+}
@@ -0,0 +1,154 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_REST_H__
+#define PMW3360_REST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_profile.h"
+
+// Number of idle gap histogram buckets, bucket k holds gaps of 2^k to 2^(k+1) milliseconds
+#define PMW3360_REST_BUCKETS                        20
+
+// Percentile of idle gaps that must wake within the latency bound
+#ifndef PMW3360_REST_PERCENTILE
+#define PMW3360_REST_PERCENTILE                     99
+#endif
+
+// Idle gaps needed before the first tuning, and after which the histogram is halved
+#ifndef PMW3360_REST_MIN_GAPS
+#define PMW3360_REST_MIN_GAPS                       32
+#endif
+#ifndef PMW3360_REST_HISTORY
+#define PMW3360_REST_HISTORY                        1024
+#endif
+
+// Modelled saving, as a right shift of the current charge, needed before the registers are rewritten
+#ifndef PMW3360_REST_MARGIN
+#define PMW3360_REST_MARGIN                         3
+#endif
+
+// Power model in microamps, run mode and a rest mode with a floor plus a charge per frame (uA*ms)
+#ifndef PMW3360_REST_RUN_CURRENT
+#define PMW3360_REST_RUN_CURRENT                    16000
+#endif
+#ifndef PMW3360_REST_FLOOR_CURRENT
+#define PMW3360_REST_FLOOR_CURRENT                  40
+#endif
+#ifndef PMW3360_REST_FRAME_CHARGE
+#define PMW3360_REST_FRAME_CHARGE                   12000
+#endif
+
+/**
+ * @brief Search over the candidate rest settings, run against a snapshot of the gap histogram
+ */
+typedef struct PMW3360_restScan
+{
+    uint32_t mean[PMW3360_REST_BUCKETS];        /**< Mean gap per bucket in milliseconds */
+    uint16_t count[PMW3360_REST_BUCKETS];       /**< Idle gaps per bucket */
+    uint16_t gaps;                              /**< Idle gaps in the snapshot */
+    uint64_t best;                              /**< Modelled charge of the best candidate so far */
+    uint16_t rest1Rate;                         /**< Rest1 rate of the next candidate row */
+    uint8_t runDownshift;                       /**< Index of the run downshift of the next candidate row */
+    bool active;                                /**< True while rows are left to score */
+    PMW3360_profile chosen;                     /**< Best candidate so far */
+} PMW3360_restScan;
+
+/**
+ * @brief Rest mode tuner learning the idle gaps between motion
+ */
+typedef struct PMW3360_rest
+{
+    PMW3360_profile profile;                    /**< Base profile carrying the tuned run downshift and Rest1 fields */
+    uint16_t count[PMW3360_REST_BUCKETS];       /**< Idle gaps per bucket */
+    uint32_t sum[PMW3360_REST_BUCKETS];         /**< Total milliseconds of the gaps per bucket */
+    uint16_t gaps;                              /**< Idle gaps in the histogram */
+    uint16_t latency;                           /**< Wake latency bound in milliseconds */
+    uint32_t interval;                          /**< Minimum milliseconds between tunings */
+    uint32_t lastMotion;                        /**< Timestamp of the last sample with motion, valid once started */
+    uint32_t lastTuning;                        /**< Timestamp of the last tuning */
+    bool started;                               /**< True once a sample with motion was seen */
+    bool idle;                                  /**< True while in an idle gap */
+    PMW3360_restScan scan;                      /**< Retune in progress */
+} PMW3360_rest;
+
+/**
+ * @brief Initialize the rest mode tuner.
+ *
+ * The base profile provides the Rest2 and Rest3 settings the model assumes.
+ * The tuner chooses the run downshift and the Rest1 settings. Rest2 and
+ * Rest3 are only entered by idle gaps past the latency percentile. The
+ * tuner writes only the run downshift, the Rest1 registers and the rest
+ * enable bit of Config2. DPI, angle and lift settings made elsewhere are
+ * left alone.
+ *
+ * @param rest Pointer to the tuner to initialize.
+ * @param base Profile to start from, applied with rest enabled on the first tuning.
+ * @param latency Wake latency bound in milliseconds.
+ * @param interval Minimum milliseconds between tunings.
+ * @return none
+ */
+void PMW3360_rest_init(PMW3360_rest *rest, const PMW3360_profile *base, uint16_t latency, uint32_t interval);
+
+/**
+ * @brief Record one sample and retune the rest modes when due.
+ *
+ * Call once per sample. A retune starts when the interval has passed and
+ * enough idle gaps were seen. It then scores one Rest1 rate row per call:
+ * nine candidates, each a walk over the non-empty buckets with no divides.
+ * A full search is nine run downshifts times one row per power of two up
+ * to the Rest2 period, 63 calls with the default profile. Registers are
+ * only written when the search ends and the chosen settings save enough.
+ * Idle samples before the first motion are not a gap, there is no start
+ * to time.
+ *
+ * @param rest Pointer to the tuner.
+ * @param data Sample read by PMW3360_read or PMW3360_readMotion.
+ * @param timestamp Sample time in milliseconds.
+ * @return True if the rest registers were rewritten
+ */
+bool PMW3360_rest_update(PMW3360_rest *rest, const PMW3360_data *data, uint32_t timestamp);
+
+/**
+ * @brief Choose the rest settings for the idle gaps seen so far.
+ *
+ * Picks the run downshift, Rest1 rate and Rest1 downshift with the lowest
+ * modelled idle power whose wake latency meets the bound for
+ * PMW3360_REST_PERCENTILE percent of the gaps. Does not touch the sensor.
+ *
+ * Runs the whole search at once, up to 567 candidates with the default
+ * profile. Each candidate walks every non-empty bucket with 64-bit
+ * multiplies. That is fine on a host but can take tens of milliseconds on
+ * a small MCU. PMW3360_rest_update spreads the same search over many
+ * calls.
+ *
+ * @param rest Pointer to the tuner.
+ * @param profile Profile to write the chosen settings into.
+ * @return False if no setting meets the bound, rest is then disabled in the profile
+ */
+bool PMW3360_rest_choose(const PMW3360_rest *rest, PMW3360_profile *profile);
+
+#endif //PMW3360_REST_H__
@@ -0,0 +1,98 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "PMW3360.h"
+#include "PMW3360_snap.h"
+
+typedef char PMW3360_snapWindowCheck[(PMW3360_SNAP_WINDOW & (PMW3360_SNAP_WINDOW - 1)) == 0 ? 1 : -1];
+
+/*
+ * Initialize the axis lock.
+ */
+void PMW3360_snap_init(PMW3360_snap *snap, uint8_t enter, uint8_t exit, uint16_t travel)
+{
+    memset(snap->absX, 0, sizeof(snap->absX));
+    memset(snap->absY, 0, sizeof(snap->absY));
+    snap->sumX = 0;
+    snap->sumY = 0;
+    snap->travel = travel;
+    snap->enter = enter;
+    snap->exit = exit > enter ? exit : enter;
+    snap->index = 0;
+    snap->axis = PMW3360_SNAP_FREE;
+
+    return;
+}
+
+/*
+ * Run one sample through the axis lock.
+ */
+uint8_t PMW3360_snap_apply(PMW3360_snap *snap, PMW3360_data *data)
+{
+    uint16_t absX, absY;
+    uint32_t on, off;
+
+    if (data->dx == 0 && data->dy == 0) {
+        return snap->axis;
+    }
+
+    // Slide the window, the running sums make this independent of the window length
+    absX = data->dx < 0 ? (uint16_t)(-(int32_t)data->dx) : (uint16_t)data->dx;
+    absY = data->dy < 0 ? (uint16_t)(-(int32_t)data->dy) : (uint16_t)data->dy;
+    snap->sumX += absX - snap->absX[snap->index];
+    snap->sumY += absY - snap->absY[snap->index];
+    snap->absX[snap->index] = absX;
+    snap->absY[snap->index] = absY;
+    snap->index = (snap->index + 1) & (PMW3360_SNAP_WINDOW - 1);
+
+    // Release when the off-axis share grows past the exit ratio
+    if (snap->axis != PMW3360_SNAP_FREE) {
+        on = snap->axis == PMW3360_SNAP_X ? snap->sumX : snap->sumY;
+        off = snap->axis == PMW3360_SNAP_X ? snap->sumY : snap->sumX;
+        if ((off << 8) > on*snap->exit) {
+            snap->axis = PMW3360_SNAP_FREE;
+        }
+    }
+
+    // Engage on the dominant axis once it has travelled far enough and the off-axis share is small
+    if (snap->axis == PMW3360_SNAP_FREE) {
+        on = snap->sumX >= snap->sumY ? snap->sumX : snap->sumY;
+        off = snap->sumX >= snap->sumY ? snap->sumY : snap->sumX;
+        if (on >= snap->travel && (off << 8) <= on*snap->enter) {
+            snap->axis = snap->sumX >= snap->sumY ? PMW3360_SNAP_X : PMW3360_SNAP_Y;
+        }
+    }
+
+    if (snap->axis == PMW3360_SNAP_X) {
+        data->dy = 0;
+    }
+    else if (snap->axis == PMW3360_SNAP_Y) {
+        data->dx = 0;
+    }
+
+    return snap->axis;
+}
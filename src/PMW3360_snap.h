@@ -0,0 +1,94 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_SNAP_H__
+#define PMW3360_SNAP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+
+// Number of moving samples in the detection window, must be a power of two
+#ifndef PMW3360_SNAP_WINDOW
+#define PMW3360_SNAP_WINDOW                         8
+#endif
+
+// Default off-axis to on-axis ratio (Q8) below which the lock engages, about tan(10 deg)
+#define PMW3360_SNAP_ENTER_DEFAULT                  45
+
+// Default off-axis to on-axis ratio (Q8) above which the lock releases, about tan(20 deg)
+#define PMW3360_SNAP_EXIT_DEFAULT                   93
+
+// Default on-axis travel over the window, in counts, needed before the lock engages
+#define PMW3360_SNAP_TRAVEL_DEFAULT                 32
+
+// Axis reported by PMW3360_snap_apply
+#define PMW3360_SNAP_FREE                           0       /**< Motion passes through unchanged */
+#define PMW3360_SNAP_X                              1       /**< Locked to the x axis, dy is zeroed */
+#define PMW3360_SNAP_Y                              2       /**< Locked to the y axis, dx is zeroed */
+
+/**
+ * @brief Software axis lock state
+ */
+typedef struct PMW3360_snap
+{
+    uint16_t absX[PMW3360_SNAP_WINDOW];     /**< |dx| of the samples in the window */
+    uint16_t absY[PMW3360_SNAP_WINDOW];     /**< |dy| of the samples in the window */
+    uint32_t sumX;                          /**< Sum of absX */
+    uint32_t sumY;                          /**< Sum of absY */
+    uint16_t travel;                        /**< On-axis travel needed to engage */
+    uint8_t enter;                          /**< Engage ratio (Q8) */
+    uint8_t exit;                           /**< Release ratio (Q8) */
+    uint8_t index;                          /**< Next window slot */
+    uint8_t axis;                           /**< Current PMW3360_SNAP_* axis */
+} PMW3360_snap;
+
+/**
+ * @brief Initialize the axis lock.
+ *
+ * The exit ratio should be above the enter ratio, the gap between the two is
+ * the hysteresis that keeps the lock from chattering near the threshold.
+ *
+ * @param snap Pointer to the axis lock to initialize.
+ * @param enter Off-axis/on-axis ratio (Q8) below which the lock engages.
+ * @param exit Off-axis/on-axis ratio (Q8) above which the lock releases.
+ * @param travel On-axis counts over the window needed to engage.
+ * @return none
+ */
+void PMW3360_snap_init(PMW3360_snap *snap, uint8_t enter, uint8_t exit, uint16_t travel);
+
+/**
+ * @brief Run one sample through the axis lock.
+ *
+ * Call after PMW3360_read or PMW3360_readMotion. While locked the off-axis
+ * component of the sample is zeroed. Samples without motion leave the window
+ * untouched, so a stroke that pauses stays locked. Takes constant time.
+ *
+ * @param snap Pointer to the axis lock.
+ * @param data Sample to filter in place.
+ * @return PMW3360_SNAP_* axis the sample was locked to
+ */
+uint8_t PMW3360_snap_apply(PMW3360_snap *snap, PMW3360_data *data);
+
+#endif //PMW3360_SNAP_H__
@@ -0,0 +1,171 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_stats.h"
+
+#if !PMW3360_ENABLE_DIAGNOSTICS
+#error "PMW3360_stats.c needs PMW3360_ENABLE_DIAGNOSTICS for the SQUAL field"
+#endif
+
+/*
+ * Initialize the statistics.
+ */
+void PMW3360_stats_init(PMW3360_stats *stats, uint8_t interval)
+{
+    stats->meanSQUAL = 0;
+    stats->varSQUAL = 0;
+    stats->meanShutter = 0;
+    stats->varShutter = 0;
+    stats->contrast = 0;
+    stats->cusum = 0;
+    stats->minSQUAL = 0xff;
+    stats->maxSQUAL = 0;
+    stats->maxShutter = 0;
+    stats->flags = 0;
+    stats->interval = interval ? interval : 1;
+    stats->countdown = 0;
+    stats->primed = false;
+
+    return;
+}
+
+/*
+ * Check whether the next sample should be a full read for the statistics.
+ */
+bool PMW3360_stats_due(PMW3360_stats *stats)
+{
+    if (stats->countdown == 0) {
+        stats->countdown = stats->interval - 1;
+        return true;
+    }
+    stats->countdown--;
+
+    return false;
+}
+
+/*
+ * Update the statistics with one full sample.
+ */
+uint8_t PMW3360_stats_update(PMW3360_stats *stats, const PMW3360_data *data)
+{
+    int32_t diff;
+    uint32_t square;
+    int32_t cusum;
+    uint8_t contrast;
+    uint8_t flags = 0;
+
+    contrast = data->maxRawData > data->minRawData ? data->maxRawData - data->minRawData : 0;
+
+    // Seed the averages with the first sample so they do not ramp up from zero
+    if (!stats->primed) {
+        stats->meanSQUAL = (uint16_t)data->SQUAL << 8;
+        stats->meanShutter = (uint32_t)data->shutter << 4;
+        stats->contrast = (uint16_t)contrast << 8;
+        stats->primed = true;
+    }
+
+    // Track extremes since reset
+    stats->minSQUAL = data->SQUAL < stats->minSQUAL ? data->SQUAL : stats->minSQUAL;
+    stats->maxSQUAL = data->SQUAL > stats->maxSQUAL ? data->SQUAL : stats->maxSQUAL;
+    stats->maxShutter = data->shutter > stats->maxShutter ? data->shutter : stats->maxShutter;
+
+    // CUSUM of SQUAL drops below the running mean detects a sudden partial lift
+    cusum = stats->cusum + (int32_t)(stats->meanSQUAL >> 8) - data->SQUAL - PMW3360_STATS_CUSUM_DRIFT;
+    cusum = cusum < 0 ? 0 : (cusum > 2*PMW3360_STATS_CUSUM_LIMIT ? 2*PMW3360_STATS_CUSUM_LIMIT : cusum);
+    stats->cusum = (int16_t)cusum;
+
+    // EWMA mean and variance of SQUAL, the squared difference fits in 32 bits unsigned
+    diff = ((int32_t)data->SQUAL << 8) - stats->meanSQUAL;
+    square = (uint32_t)(diff < 0 ? -diff : diff);
+    square = (square*square) >> 12;
+    stats->meanSQUAL = (uint16_t)(stats->meanSQUAL + (diff >> PMW3360_STATS_SHIFT));
+    stats->varSQUAL = (uint16_t)((int32_t)stats->varSQUAL +
+                                 (((int32_t)(square > 0xffff ? 0xffff : square) - stats->varSQUAL) >> PMW3360_STATS_SHIFT));
+
+    // EWMA mean and variance of shutter
+    diff = (int32_t)data->shutter - (int32_t)(stats->meanShutter >> 4);
+    square = (uint32_t)(diff < 0 ? -diff : diff);
+    square = square*square;
+    stats->meanShutter = (uint32_t)((int32_t)stats->meanShutter + ((diff*16) >> PMW3360_STATS_SHIFT));
+    if (square >= stats->varShutter) {
+        stats->varShutter += (square - stats->varShutter) >> PMW3360_STATS_SHIFT;
+    }
+    else {
+        stats->varShutter -= (stats->varShutter - square) >> PMW3360_STATS_SHIFT;
+    }
+
+    // Slow EWMA of image contrast, only meaningful while on the surface
+    if (data->surface) {
+        diff = ((int32_t)contrast << 8) - stats->contrast;
+        stats->contrast = (uint16_t)(stats->contrast + (diff >> PMW3360_STATS_SLOW_SHIFT));
+    }
+
+    // Classify the current state
+    if (!data->surface) {
+        flags |= PMW3360_STATS_LIFT;
+    }
+    else if (stats->cusum >= PMW3360_STATS_CUSUM_LIMIT) {
+        flags |= PMW3360_STATS_PARTIAL_LIFT;
+    }
+    if ((stats->meanSQUAL >> 8) < PMW3360_STATS_BAD_SQUAL) {
+        flags |= PMW3360_STATS_BAD_SURFACE;
+    }
+    if ((stats->contrast >> 8) < PMW3360_STATS_DIRTY_CONTRAST) {
+        flags |= PMW3360_STATS_DIRTY_OPTICS;
+    }
+    stats->flags = flags;
+
+    return flags;
+}
+
+/*
+ * Serialize the statistics into a little-endian diagnostic report.
+ */
+void PMW3360_stats_report(const PMW3360_stats *stats, uint8_t *buffer)
+{
+    uint16_t meanShutter = (uint16_t)(stats->meanShutter >> 4);
+    uint16_t varShutter = (uint16_t)(stats->varShutter >> 8 > 0xffff ? 0xffff : stats->varShutter >> 8);
+
+    buffer[0] = stats->flags;
+    buffer[1] = stats->minSQUAL;
+    buffer[2] = stats->maxSQUAL;
+    buffer[3] = (uint8_t)stats->meanSQUAL;
+    buffer[4] = (uint8_t)(stats->meanSQUAL >> 8);
+    buffer[5] = (uint8_t)stats->varSQUAL;
+    buffer[6] = (uint8_t)(stats->varSQUAL >> 8);
+    buffer[7] = (uint8_t)meanShutter;
+    buffer[8] = (uint8_t)(meanShutter >> 8);
+    buffer[9] = (uint8_t)varShutter;
+    buffer[10] = (uint8_t)(varShutter >> 8);
+    buffer[11] = (uint8_t)stats->maxShutter;
+    buffer[12] = (uint8_t)(stats->maxShutter >> 8);
+    buffer[13] = (uint8_t)stats->contrast;
+    buffer[14] = (uint8_t)(stats->contrast >> 8);
+    buffer[15] = 0;
+
+    return;
+}
@@ -0,0 +1,133 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PMW3360_STATS_H__
+#define PMW3360_STATS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+
+// EWMA weight as a right shift, alpha = 1/2^shift
+#ifndef PMW3360_STATS_SHIFT
+#define PMW3360_STATS_SHIFT                         4
+#endif
+
+// Slow EWMA weight used for the contrast average that tracks dirty optics
+#ifndef PMW3360_STATS_SLOW_SHIFT
+#define PMW3360_STATS_SLOW_SHIFT                    8
+#endif
+
+// Mean SQUAL below which the surface is flagged as bad
+#ifndef PMW3360_STATS_BAD_SQUAL
+#define PMW3360_STATS_BAD_SQUAL                     16
+#endif
+
+// SQUAL drop (below the mean) tolerated by the change-point detector
+#ifndef PMW3360_STATS_CUSUM_DRIFT
+#define PMW3360_STATS_CUSUM_DRIFT                   4
+#endif
+
+// Accumulated SQUAL drop at which a change point is flagged
+#ifndef PMW3360_STATS_CUSUM_LIMIT
+#define PMW3360_STATS_CUSUM_LIMIT                   64
+#endif
+
+// Mean contrast (max - min raw data) below which the optics are flagged as dirty
+#ifndef PMW3360_STATS_DIRTY_CONTRAST
+#define PMW3360_STATS_DIRTY_CONTRAST                8
+#endif
+
+// Flags reported by PMW3360_stats_update
+#define PMW3360_STATS_LIFT                          0x01    /**< Sensor reports it is off the surface */
+#define PMW3360_STATS_PARTIAL_LIFT                  0x02    /**< SQUAL dropped suddenly while on the surface */
+#define PMW3360_STATS_BAD_SURFACE                   0x04    /**< Mean SQUAL is persistently low */
+#define PMW3360_STATS_DIRTY_OPTICS                  0x08    /**< Mean image contrast is persistently low */
+
+// Size in bytes of the report written by PMW3360_stats_report
+#define PMW3360_STATS_REPORT_SIZE                   16
+
+/**
+ * @brief Running surface-quality statistics
+ */
+typedef struct PMW3360_stats
+{
+    uint16_t meanSQUAL;         /**< EWMA of SQUAL (Q8) */
+    uint16_t varSQUAL;          /**< EWMA variance of SQUAL (Q4) */
+    uint32_t meanShutter;       /**< EWMA of shutter (Q4) */
+    uint32_t varShutter;        /**< EWMA variance of shutter */
+    uint16_t contrast;          /**< Slow EWMA of max - min raw data (Q8) */
+    int16_t cusum;              /**< CUSUM of SQUAL drops below the mean */
+    uint8_t minSQUAL;           /**< Minimum SQUAL since reset */
+    uint8_t maxSQUAL;           /**< Maximum SQUAL since reset */
+    uint16_t maxShutter;        /**< Maximum shutter since reset */
+    uint8_t flags;              /**< Most recent PMW3360_STATS_* flags */
+    uint8_t interval;           /**< Update statistics every interval samples */
+    uint8_t countdown;          /**< Samples left until the next statistics sample */
+    bool primed;                /**< True once the averages are seeded */
+} PMW3360_stats;
+
+/**
+ * @brief Initialize the statistics.
+ *
+ * @param stats Pointer to the statistics to initialize.
+ * @param interval Gather statistics every interval samples, 1 for every sample.
+ * @return none
+ */
+void PMW3360_stats_init(PMW3360_stats *stats, uint8_t interval);
+
+/**
+ * @brief Check whether the next sample should be a full read for the statistics.
+ *
+ * Call once per sample. When this returns false the caller can use
+ * PMW3360_readMotion instead of PMW3360_read and skip PMW3360_stats_update.
+ *
+ * @param stats Pointer to the statistics.
+ * @return True if the next sample should be read with PMW3360_read
+ */
+bool PMW3360_stats_due(PMW3360_stats *stats);
+
+/**
+ * @brief Update the statistics with one full sample.
+ *
+ * @param stats Pointer to the statistics.
+ * @param data Sample read by PMW3360_read.
+ * @return PMW3360_STATS_* flags for the current state
+ */
+uint8_t PMW3360_stats_update(PMW3360_stats *stats, const PMW3360_data *data);
+
+/**
+ * @brief Serialize the statistics into a little-endian diagnostic report.
+ *
+ * Layout: flags, min SQUAL, max SQUAL, mean SQUAL (Q8, 2 bytes), SQUAL
+ * variance (Q4, 2 bytes), mean shutter (2 bytes), shutter variance >> 8
+ * (2 bytes), max shutter (2 bytes), contrast (Q8, 2 bytes), reserved.
+ *
+ * @param stats Pointer to the statistics.
+ * @param buffer Buffer of at least PMW3360_STATS_REPORT_SIZE bytes.
+ * @return none
+ */
+void PMW3360_stats_report(const PMW3360_stats *stats, uint8_t *buffer);
+
+#endif //PMW3360_STATS_H__
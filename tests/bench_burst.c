@@ -0,0 +1,70 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "PMW3360.h"
+#include "observer.h"
+#include "bench.h"
+
+// Reads per timed run, the best of several runs is reported
+#define READS       20000
+#define RUNS        5
+
+/*
+ * Host CPU time per PMW3360_read, built with and without burst checking to show what the check costs per sample.
+ */
+int main()
+{
+    PMW3360_data data;
+    uint64_t best = UINT64_MAX, start, ns, cycles = 0, c;
+    int run, i;
+
+    observer_reset();
+    if (!PMW3360_init()) {
+        printf("initialization failed\n");
+        return 1;
+    }
+
+    for (run = 0; run < RUNS; run++) {
+        start = bench_ns();
+        c = bench_cycles();
+        for (i = 0; i < READS; i++) {
+            PMW3360_read(&data);
+            BENCH_KEEP(data.dx);
+        }
+        c = bench_cycles() - c;
+        ns = bench_ns() - start;
+        if (ns < best) {
+            best = ns;
+            cycles = c;
+        }
+    }
+
+    printf("%-28s %12s %12s\n", "", "host ns", "cycles");
+    printf("%-28s %12.1f %12.1f\n", PMW3360_CHECK_BURST ? "PMW3360_read, burst check" : "PMW3360_read, no check",
+           (double)best/READS, (double)cycles/READS);
+
+    return data.motion ? 0 : 1;
+}
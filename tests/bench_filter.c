@@ -0,0 +1,192 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "PMW3360.h"
+#include "PMW3360_filter.h"
+#include "PMW3360_accel.h"
+#include "bench.h"
+
+// Samples in the synthetic trace
+#define SAMPLES     100000
+
+// Largest allowed distance between the fixed-point and the float pointer position, in counts
+#define TOLERANCE   2.0
+
+/*
+ * Floating-point reference of PMW3360_filter_apply: same window and curve
+ * index, exact gain and smoothing, no rounding.
+ */
+typedef struct reference
+{
+    PMW3360_filter window;
+    double smoothX;
+    double smoothY;
+} reference;
+
+static void reference_apply(reference *ref, const PMW3360_filter *config, int16_t dx, int16_t dy, double *x, double *y)
+{
+    PMW3360_filter *w = &ref->window;
+    int32_t ax, ay, speed;
+    uint8_t index;
+    double gain, alpha;
+
+    w->sumX += dx - w->windowX[w->head];
+    w->sumY += dy - w->windowY[w->head];
+    w->windowX[w->head] = dx;
+    w->windowY[w->head] = dy;
+    w->head = (w->head + 1) & (PMW3360_FILTER_WINDOW - 1);
+    ax = w->sumX < 0 ? -w->sumX : w->sumX;
+    ay = w->sumY < 0 ? -w->sumY : w->sumY;
+    speed = (ax > ay ? ax + (ay >> 1) : ay + (ax >> 1)) >> PMW3360_FILTER_SPEED_SHIFT;
+    index = speed < PMW3360_ACCEL_LUT_SIZE ? (uint8_t)speed : PMW3360_ACCEL_LUT_SIZE - 1;
+
+    switch (config->curve) {
+    case PMW3360_ACCEL_LINEAR:
+        gain = PMW3360_accelLinear[index]/256.0;
+        break;
+    case PMW3360_ACCEL_POWER:
+        gain = PMW3360_accelPower[index]/256.0;
+        break;
+    case PMW3360_ACCEL_SIGMOID:
+        gain = PMW3360_accelSigmoid[index]/256.0;
+        break;
+    default:
+        gain = 1.0;
+        break;
+    }
+
+    *x = dx*gain;
+    *y = dy*gain;
+    if (config->smoothing != PMW3360_SMOOTHING_NONE) {
+        alpha = config->alpha/256.0;
+        if (config->smoothing == PMW3360_SMOOTHING_ONE_EURO) {
+            alpha = fmin(alpha + ((config->beta*index) >> 8)/256.0, 1.0);
+        }
+        ref->smoothX += (*x - ref->smoothX)*alpha;
+        ref->smoothY += (*y - ref->smoothY)*alpha;
+        *x = ref->smoothX;
+        *y = ref->smoothY;
+    }
+
+    return;
+}
+
+/*
+ * Hand motion: strokes of varying speed and direction with sensor noise.
+ */
+static void trace(int16_t *dx, int16_t *dy)
+{
+    uint32_t seed = 1;
+    int i;
+
+    for (i = 0; i < SAMPLES; i++) {
+        double t = i/1000.0;
+        double speed = 40.0*fabs(sin(t*0.7))*fabs(sin(t*3.1));
+
+        seed = seed*1103515245u + 12345u;
+        dx[i] = (int16_t)lrint(speed*cos(t) + (int32_t)(seed >> 28) - 8);
+        dy[i] = (int16_t)lrint(speed*sin(t*1.3) + (int32_t)(seed >> 24 & 0xf) - 8);
+    }
+
+    return;
+}
+
+/*
+ * Run one configuration, returns false when the pointer drifts from the reference.
+ */
+static bool bench(const char *name, PMW3360_accelCurve curve, PMW3360_smoothing smoothing, const int16_t *dx, const int16_t *dy)
+{
+    PMW3360_filter filter;
+    reference ref = { 0 };
+    PMW3360_data data = { 0 };
+    double x, y, refX = 0.0, refY = 0.0, error = 0.0;
+    int64_t posX = 0, posY = 0;
+    uint64_t ns, cycles, refNs, refCycles;
+    int i;
+
+    // Accuracy pass, the pointer position of both must stay within the tolerance
+    PMW3360_filter_init(&filter, curve, smoothing, 48, 32);
+    for (i = 0; i < SAMPLES; i++) {
+        data.dx = dx[i];
+        data.dy = dy[i];
+        PMW3360_filter_apply(&filter, &data);
+        reference_apply(&ref, &filter, dx[i], dy[i], &x, &y);
+        posX += data.dx;
+        posY += data.dy;
+        refX += x;
+        refY += y;
+        error = fmax(error, fmax(fabs(posX - refX), fabs(posY - refY)));
+    }
+
+    // Timed passes
+    PMW3360_filter_init(&filter, curve, smoothing, 48, 32);
+    ns = bench_ns();
+    cycles = bench_cycles();
+    for (i = 0; i < SAMPLES; i++) {
+        data.dx = dx[i];
+        data.dy = dy[i];
+        PMW3360_filter_apply(&filter, &data);
+        BENCH_KEEP(data.dx);
+        BENCH_KEEP(data.dy);
+    }
+    cycles = bench_cycles() - cycles;
+    ns = bench_ns() - ns;
+
+    ref = (reference){ 0 };
+    refNs = bench_ns();
+    refCycles = bench_cycles();
+    for (i = 0; i < SAMPLES; i++) {
+        reference_apply(&ref, &filter, dx[i], dy[i], &x, &y);
+        BENCH_KEEP(x);
+        BENCH_KEEP(y);
+    }
+    refCycles = bench_cycles() - refCycles;
+    refNs = bench_ns() - refNs;
+
+    printf("%-18s %10.1f %10.1f %10.1f %10.1f %10.3f\n", name,
+           (double)cycles/SAMPLES, (double)ns/SAMPLES, (double)refCycles/SAMPLES, (double)refNs/SAMPLES, error);
+
+    return error <= TOLERANCE;
+}
+
+int main()
+{
+    static int16_t dx[SAMPLES], dy[SAMPLES];
+    bool ok = true;
+
+    trace(dx, dy);
+
+    printf("%-18s %10s %10s %10s %10s %10s\n", "", "cycles", "ns", "float cyc", "float ns", "max error");
+    ok &= bench("none", PMW3360_ACCEL_NONE, PMW3360_SMOOTHING_NONE, dx, dy);
+    ok &= bench("linear", PMW3360_ACCEL_LINEAR, PMW3360_SMOOTHING_NONE, dx, dy);
+    ok &= bench("linear ema", PMW3360_ACCEL_LINEAR, PMW3360_SMOOTHING_EMA, dx, dy);
+    ok &= bench("power ema", PMW3360_ACCEL_POWER, PMW3360_SMOOTHING_EMA, dx, dy);
+    ok &= bench("sigmoid 1-euro", PMW3360_ACCEL_SIGMOID, PMW3360_SMOOTHING_ONE_EURO, dx, dy);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "PMW3360.h"
+#include "PMW3360_frame.h"
+#include "bench.h"
+
+// Frames per timed pass, cycling through the synthetic set
+#define FRAMES      100000
+#define SET         64
+
+// Name of the stats and sharpness kernels this build uses, the same selection PMW3360_frame.c makes
+#if PMW3360_FRAME_SIMD && defined(__SSE2__)
+#define KERNEL      "sse2"
+#elif PMW3360_FRAME_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#define KERNEL      "neon"
+#else
+#define KERNEL      "swar"
+#endif
+
+// Histogram and fixed-pattern-noise accumulation are word-parallel on every target
+#define KERNEL_SWAR "swar"
+
+/*
+ * Plain per-pixel reference of PMW3360_frame_stats and PMW3360_frame_sharpness.
+ */
+static void reference(const uint8_t *frame, PMW3360_frameStats *stats, uint32_t *sharpness)
+{
+    uint32_t sum = 0, squares = 0;
+    uint64_t variance;
+    int r, c, a, b;
+
+    stats->min = 0xff;
+    stats->max = 0;
+    *sharpness = 0;
+    for (r = 0; r < PMW3360_FRAME_WIDTH; r++) {
+        for (c = 0; c < PMW3360_FRAME_WIDTH; c++) {
+            a = frame[r*PMW3360_FRAME_WIDTH + c];
+            stats->min = a < stats->min ? a : stats->min;
+            stats->max = a > stats->max ? a : stats->max;
+            sum += a;
+            squares += a*a;
+            if (c + 1 < PMW3360_FRAME_WIDTH) {
+                b = frame[r*PMW3360_FRAME_WIDTH + c + 1];
+                *sharpness += a > b ? a - b : b - a;
+            }
+            if (r + 1 < PMW3360_FRAME_WIDTH) {
+                b = frame[(r + 1)*PMW3360_FRAME_WIDTH + c];
+                *sharpness += a > b ? a - b : b - a;
+            }
+        }
+    }
+    stats->mean = (uint16_t)((sum << 8)/PMW3360_FRAME_SIZE);
+    variance = (uint64_t)squares*PMW3360_FRAME_SIZE - (uint64_t)sum*sum;
+    stats->variance = (uint32_t)((variance << 8)/((uint32_t)PMW3360_FRAME_SIZE*PMW3360_FRAME_SIZE));
+
+    return;
+}
+
+/*
+ * Plain per-pixel reference of PMW3360_frame_histogram.
+ */
+static bool referenceHistogram(const uint8_t *frame, const uint16_t *histogram)
+{
+    uint16_t expected[256] = { 0 };
+    int i;
+
+    for (i = 0; i < PMW3360_FRAME_SIZE; i++) {
+        expected[frame[i]]++;
+    }
+    for (i = 0; i < 256; i++) {
+        if (histogram[i] != expected[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Plain per-pixel reference of PMW3360_fpn_estimate over a set of frames.
+ */
+static uint32_t referenceFpn(uint8_t set[SET][PMW3360_FRAME_SIZE])
+{
+    uint64_t sum = 0, squares = 0, pixel, n;
+    int f, i;
+
+    for (i = 0; i < PMW3360_FRAME_SIZE; i++) {
+        pixel = 0;
+        for (f = 0; f < SET; f++) {
+            pixel += set[f][i];
+        }
+        sum += pixel;
+        squares += pixel*pixel;
+    }
+    n = (uint64_t)SET*PMW3360_FRAME_SIZE;
+
+    return (uint32_t)(((squares*PMW3360_FRAME_SIZE - sum*sum) << 8)/(n*n));
+}
+
+/*
+ * Surface-like frames: a smooth gradient, texture and a few saturated or black pixels.
+ */
+static void frames(uint8_t set[SET][PMW3360_FRAME_SIZE])
+{
+    uint32_t seed = 7;
+    int f, i, value;
+
+    for (f = 0; f < SET; f++) {
+        for (i = 0; i < PMW3360_FRAME_SIZE; i++) {
+            seed = seed*1103515245u + 12345u;
+            value = 40 + f + (i % PMW3360_FRAME_WIDTH)*2 + (int)(seed >> 26);
+            value = (seed >> 16 & 0x1ff) == 0 ? 255 : ((seed >> 16 & 0x1ff) == 1 ? 0 : value);
+            set[f][i] = (uint8_t)(value > 255 ? 255 : value);
+        }
+    }
+
+    return;
+}
+
+/*
+ * Print one kernel's rate in frames per second.
+ */
+static void report(const char *kernel, const char *name, uint64_t ns, uint64_t cycles)
+{
+    printf("%-6s %-12s %12.0f %10.1f %10.1f\n", kernel, name, FRAMES*1e9/ns, (double)cycles/FRAMES, (double)ns/FRAMES);
+
+    return;
+}
+
+int main()
+{
+    static uint8_t set[SET][PMW3360_FRAME_SIZE];
+    static uint16_t histogram[256];
+    static PMW3360_fpn fpn;
+    PMW3360_frameStats stats, expected;
+    uint32_t sharpness, expectedSharpness;
+    uint64_t ns, cycles;
+    bool ok = true;
+    int i;
+
+    frames(set);
+
+    // Every kernel must agree with the reference before its timing means anything
+    PMW3360_fpn_init(&fpn);
+    for (i = 0; i < SET; i++) {
+        PMW3360_frame_stats(set[i], &stats);
+        reference(set[i], &expected, &expectedSharpness);
+        ok &= stats.min == expected.min && stats.max == expected.max &&
+              stats.mean == expected.mean && stats.variance == expected.variance;
+        ok &= PMW3360_frame_sharpness(set[i]) == expectedSharpness;
+        PMW3360_frame_histogram(set[i], histogram);
+        ok &= referenceHistogram(set[i], histogram);
+        ok &= PMW3360_fpn_add(&fpn, set[i]);
+    }
+    ok &= PMW3360_fpn_estimate(&fpn) == referenceFpn(set);
+    if (!ok) {
+        printf("kernels disagree with the reference\n");
+    }
+
+    printf("%-6s %-12s %12s %10s %10s\n", "", "", "frames/s", "cycles", "ns");
+
+    ns = bench_ns();
+    cycles = bench_cycles();
+    for (i = 0; i < FRAMES; i++) {
+        PMW3360_frame_stats(set[i % SET], &stats);
+        BENCH_KEEP(stats.variance);
+    }
+    report(KERNEL, "stats", bench_ns() - ns, bench_cycles() - cycles);
+
+    ns = bench_ns();
+    cycles = bench_cycles();
+    for (i = 0; i < FRAMES; i++) {
+        sharpness = PMW3360_frame_sharpness(set[i % SET]);
+        BENCH_KEEP(sharpness);
+    }
+    report(KERNEL, "sharpness", bench_ns() - ns, bench_cycles() - cycles);
+
+    ns = bench_ns();
+    cycles = bench_cycles();
+    for (i = 0; i < FRAMES; i++) {
+        PMW3360_frame_histogram(set[i % SET], histogram);
+        BENCH_KEEP(histogram[0]);
+    }
+    report(KERNEL_SWAR, "histogram", bench_ns() - ns, bench_cycles() - cycles);
+
+    PMW3360_fpn_init(&fpn);
+    ns = bench_ns();
+    cycles = bench_cycles();
+    for (i = 0; i < FRAMES; i++) {
+        if (fpn.frames == PMW3360_FPN_MAX_FRAMES) {
+            PMW3360_fpn_init(&fpn);
+        }
+        PMW3360_fpn_add(&fpn, set[i % SET]);
+        BENCH_KEEP(fpn.sum[0]);
+    }
+    report(KERNEL_SWAR, "fpn_add", bench_ns() - ns, bench_cycles() - cycles);
+
+    return ok ? 0 : 1;
+}
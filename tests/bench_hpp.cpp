@@ -0,0 +1,84 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "PMW3360.h"
+#include "PMW3360.hpp"
+#include "observer.h"
+#include "bench.h"
+
+// Reads per timed run, the best of several runs is reported
+#define READS       20000
+#define RUNS        5
+
+// Allowed host CPU time of the template driver relative to the C driver
+#define MARGIN      1.10
+
+using Sensor = pmw3360::PMW3360<pmw3360::PicoPort<0, 18, 19, 20, 21>>;
+
+/*
+ * Best host CPU time per read in nanoseconds, and the simulated bus time per read in microseconds.
+ */
+template <class Read>
+static double bench(Read read, double *bus)
+{
+    PMW3360_data data = {};
+    uint64_t best = UINT64_MAX, start, ns, now;
+
+    for (int run = 0; run < RUNS; run++) {
+        now = observer_now();
+        start = bench_ns();
+        for (int i = 0; i < READS; i++) {
+            read(data);
+            BENCH_KEEP(data.dx);
+        }
+        ns = bench_ns() - start;
+        best = ns < best ? ns : best;
+        *bus = (double)(observer_now() - now)/1000.0/READS;
+    }
+
+    return (double)best/READS;
+}
+
+int main()
+{
+    double c, cpp, cBus, cppBus;
+
+    // Both drivers talk to the same simulated sensor through the same Pico SDK stand-ins
+    observer_reset();
+    if (!PMW3360_init() || !Sensor::init()) {
+        printf("initialization failed\n");
+        return 1;
+    }
+
+    c = bench([](PMW3360_data &data) { PMW3360_read(&data); }, &cBus);
+    cpp = bench([](PMW3360_data &data) { Sensor::read(data); }, &cppBus);
+
+    printf("%-22s %12s %12s\n", "", "host ns", "bus us");
+    printf("%-22s %12.1f %12.1f\n", "PMW3360_read", c, cBus);
+    printf("%-22s %12.1f %12.1f\n", "pmw3360::PMW3360 read", cpp, cppBus);
+
+    return cpp <= c*MARGIN ? 0 : 1;
+}
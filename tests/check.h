@@ -0,0 +1,56 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHECK_H__
+#define CHECK_H__
+
+#include <stdio.h>
+
+/*
+ * Minimal checks for the host tests. A failed check prints its location and
+ * the test keeps running, main returns CHECK_RESULT() so ctest sees the failure.
+ */
+
+static int check_failed;
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+            check_failed++;                                                     \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                          \
+    do {                                                                        \
+        long check_a = (long)(a), check_b = (long)(b);                          \
+        if (check_a != check_b) {                                               \
+            printf("%s:%d: check failed: %s == %s (%ld != %ld)\n",              \
+                   __FILE__, __LINE__, #a, #b, check_a, check_b);               \
+            check_failed++;                                                     \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_RESULT()  (check_failed ? 1 : 0)
+
+#endif //CHECK_H__
@@ -0,0 +1,17 @@
+# regenerates the acceleration tables and fails when the checked-in header differs,
+# run with: cmake -DPYTHON=<python3> -DSOURCE=<repository> -DOUTPUT=<file> -P check_accel_lut.cmake
+execute_process(
+	COMMAND ${PYTHON} ${SOURCE}/tools/gen_accel_lut.py
+	OUTPUT_FILE ${OUTPUT}
+	RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "tools/gen_accel_lut.py failed")
+endif()
+execute_process(
+	COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT} ${SOURCE}/src/PMW3360_accel.h
+	RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "src/PMW3360_accel.h is out of date, run: python3 tools/gen_accel_lut.py > src/PMW3360_accel.h")
+endif()
@@ -0,0 +1,100 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "observer.h"
+#include "check.h"
+
+#if !PMW3360_CHECK_BURST
+#error "test_burst needs PMW3360_CHECK_BURST=1"
+#endif
+
+/*
+ * Read one sample with the next bursts corrupted, and check what the retries and counters made of it.
+ */
+static void checkRead(const uint8_t *burst, uint32_t bad, bool moved, const PMW3360_burstStats *expected)
+{
+    PMW3360_burstStats before, after;
+    PMW3360_data data;
+    uint32_t writes;
+
+    PMW3360_getBurstStats(&before);
+    observer_injectBursts(burst, bad);
+    writes = observer_writes();
+    CHECK(PMW3360_read(&data));
+    PMW3360_getBurstStats(&after);
+
+    CHECK_EQ(data.motion, moved);
+    CHECK_EQ(data.dx, moved ? 1 : 0);
+    CHECK_EQ(data.dy, moved ? 1 : 0);
+    CHECK_EQ(after.checked - before.checked, expected->checked);
+    CHECK_EQ(after.rejected - before.rejected, expected->rejected);
+    CHECK_EQ(after.retried - before.retried, expected->retried);
+    CHECK_EQ(after.failed - before.failed, expected->failed);
+
+    // Every burst, the first and each retry, latches with one Motion_Burst write
+    CHECK_EQ(observer_writes() - writes, 1 + expected->retried);
+    observer_injectBursts(burst, 0);
+
+    return;
+}
+
+int main()
+{
+    static const uint8_t ones[12] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    static const uint8_t zeros[12] = { 0 };
+    static const uint8_t reserved[12] = { 0x80 | 0x10, 0x00, 0x01, 0x00, 0x01, 0x00, 0x40, 0x30, 0x80, 0x10, 0x20, 0x01 };
+    static const PMW3360_burstStats clean = { 1, 0, 0, 0 };
+    static const PMW3360_burstStats once = { 1, 1, 1, 0 };
+    static const PMW3360_burstStats exhausted = { 1, PMW3360_CHECK_RETRIES + 1, PMW3360_CHECK_RETRIES, 1 };
+    int padded = 0;
+
+    observer_reset();
+    CHECK(PMW3360_init());
+
+    // A healthy burst passes on the first read
+    checkRead(zeros, 0, true, &clean);
+
+    // A single glitch of each kind costs one retry, the sample still carries the motion
+    checkRead(ones, 1, true, &once);
+    checkRead(zeros, 1, true, &once);
+    checkRead(reserved, 1, true, &once);
+
+    // A fault lasting the whole retry budget reports no motion, and reads no further bursts
+    checkRead(ones, PMW3360_CHECK_RETRIES + 1, false, &exhausted);
+    checkRead(zeros, PMW3360_CHECK_RETRIES + 1, false, &exhausted);
+    checkRead(reserved, PMW3360_CHECK_RETRIES + 1, false, &exhausted);
+
+    // A longer fault is the next sample's problem, this one still reads only its budget
+    checkRead(ones, PMW3360_CHECK_RETRIES + 2, false, &exhausted);
+
+    // The bus timing held through all the retries
+    CHECK_EQ(observer_report(&padded), 0);
+
+    PMW3360_shutdown();
+
+    return CHECK_RESULT();
+}
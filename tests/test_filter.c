@@ -0,0 +1,156 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_filter.h"
+#include "check.h"
+
+// Zero samples fed after the motion so the smoothing stage drains completely
+#define DRAIN       8000
+
+/*
+ * Feed a trace followed by zeros, return the total output on each axis.
+ */
+static void run(PMW3360_filter *filter, const int16_t *dx, const int16_t *dy, int n, int32_t *sumX, int32_t *sumY)
+{
+    PMW3360_data data = { 0 };
+    int i;
+
+    *sumX = 0;
+    *sumY = 0;
+    for (i = 0; i < n + DRAIN; i++) {
+        data.dx = i < n ? dx[i] : 0;
+        data.dy = i < n ? dy[i] : 0;
+        PMW3360_filter_apply(filter, &data);
+        *sumX += data.dx;
+        *sumY += data.dy;
+    }
+
+    return;
+}
+
+/*
+ * A single small step must come out whole in both directions.
+ */
+static void testImpulse(PMW3360_smoothing smoothing, uint8_t alpha)
+{
+    static const int16_t plus[1] = { 3 };
+    static const int16_t minus[1] = { -3 };
+    PMW3360_filter filter;
+    int32_t x, y;
+
+    PMW3360_filter_init(&filter, PMW3360_ACCEL_NONE, smoothing, alpha, 16);
+    run(&filter, minus, plus, 1, &x, &y);
+    CHECK_EQ(x, -3);
+    CHECK_EQ(y, 3);
+
+    PMW3360_filter_init(&filter, PMW3360_ACCEL_NONE, smoothing, alpha, 16);
+    run(&filter, plus, minus, 1, &x, &y);
+    CHECK_EQ(x, 3);
+    CHECK_EQ(y, -3);
+
+    // The smoothed value settles on zero, nothing keeps leaking out after the drain
+    CHECK_EQ(filter.smoothX, 0);
+    CHECK_EQ(filter.smoothY, 0);
+
+    return;
+}
+
+/*
+ * A trace and its mirror image must give mirrored output sample by sample.
+ */
+static void testMirror(PMW3360_accelCurve curve, PMW3360_smoothing smoothing)
+{
+    PMW3360_filter a, b;
+    PMW3360_data da = { 0 }, db = { 0 };
+    uint32_t seed = 12345;
+    int i;
+
+    PMW3360_filter_init(&a, curve, smoothing, 40, 24);
+    PMW3360_filter_init(&b, curve, smoothing, 40, 24);
+    for (i = 0; i < 4000; i++) {
+        seed = seed*1103515245u + 12345u;
+        da.dx = (int16_t)((int32_t)(seed >> 16 & 0xff) - 128)/(i & 64 ? 1 : 16);
+        da.dy = (int16_t)((int32_t)(seed >> 8 & 0x1f) - 16);
+        db.dx = -da.dx;
+        db.dy = -da.dy;
+        PMW3360_filter_apply(&a, &da);
+        PMW3360_filter_apply(&b, &db);
+        if (da.dx != -db.dx || da.dy != -db.dy) {
+            CHECK(false);
+            break;
+        }
+    }
+
+    return;
+}
+
+/*
+ * With unity gain the filter only delays motion, the total is kept.
+ */
+static void testTotal(PMW3360_smoothing smoothing, uint8_t alpha)
+{
+    static int16_t dx[500], dy[500];
+    PMW3360_filter filter;
+    int32_t inX = 0, inY = 0, x, y;
+    int i;
+
+    for (i = 0; i < 500; i++) {
+        dx[i] = (int16_t)((i*37 % 23) - 11);
+        dy[i] = (int16_t)((i*13 % 7) - 4);
+        inX += dx[i];
+        inY += dy[i];
+    }
+    PMW3360_filter_init(&filter, PMW3360_ACCEL_NONE, smoothing, alpha, 16);
+    run(&filter, dx, dy, 500, &x, &y);
+    CHECK_EQ(x, inX);
+    CHECK_EQ(y, inY);
+
+    return;
+}
+
+int main()
+{
+    static const uint8_t alphas[] = { 8, 32, 64, 100, 255 };
+    uint8_t i;
+
+    for (i = 0; i < sizeof(alphas); i++) {
+        testImpulse(PMW3360_SMOOTHING_EMA, alphas[i]);
+        testImpulse(PMW3360_SMOOTHING_ONE_EURO, alphas[i]);
+        testTotal(PMW3360_SMOOTHING_EMA, alphas[i]);
+        testTotal(PMW3360_SMOOTHING_ONE_EURO, alphas[i]);
+    }
+    testImpulse(PMW3360_SMOOTHING_NONE, 0);
+    testTotal(PMW3360_SMOOTHING_NONE, 0);
+
+    for (i = PMW3360_ACCEL_NONE; i <= PMW3360_ACCEL_SIGMOID; i++) {
+        testMirror((PMW3360_accelCurve)i, PMW3360_SMOOTHING_NONE);
+        testMirror((PMW3360_accelCurve)i, PMW3360_SMOOTHING_EMA);
+        testMirror((PMW3360_accelCurve)i, PMW3360_SMOOTHING_ONE_EURO);
+    }
+
+    return CHECK_RESULT();
+}
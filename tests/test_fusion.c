@@ -0,0 +1,132 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "PMW3360.h"
+#include "PMW3360_fusion.h"
+#include "check.h"
+
+// Frames in the synthetic trace
+#define FRAMES      1000
+
+/*
+ * One simulated sensor fixed to the body, accumulating its exact motion and
+ * reporting whole counts like the sensor does.
+ */
+typedef struct sensor
+{
+    PMW3360_fusionSensor mount;
+    double angle;
+    double countX;
+    double countY;
+} sensor;
+
+static void sensor_init(sensor *s, uint16_t cpi, double angle, int32_t x, int32_t y)
+{
+    s->mount.cpi = cpi;
+    s->mount.cosAngle = PMW3360_FUSION_Q14(cos(angle));
+    s->mount.sinAngle = PMW3360_FUSION_Q14(sin(angle));
+    s->mount.x = x;
+    s->mount.y = y;
+    s->angle = angle;
+    s->countX = 0.0;
+    s->countY = 0.0;
+
+    return;
+}
+
+/*
+ * Move the body by (vx, vy) micrometers and w radians about its origin, return the sensor's sample.
+ */
+static void sensor_move(sensor *s, double vx, double vy, double w, PMW3360_data *data)
+{
+    double bx = vx - w*s->mount.y;
+    double by = vy + w*s->mount.x;
+    double scale = s->mount.cpi/25400.0;
+    int32_t dx, dy;
+
+    // Body frame displacement turned into the sensor's frame
+    s->countX += (cos(s->angle)*bx + sin(s->angle)*by)*scale;
+    s->countY += (-sin(s->angle)*bx + cos(s->angle)*by)*scale;
+    dx = (int32_t)s->countX;
+    dy = (int32_t)s->countY;
+    s->countX -= dx;
+    s->countY -= dy;
+
+    data->dx = (int16_t)dx;
+    data->dy = (int16_t)dy;
+    data->SQUAL = 0x40;
+    data->surface = true;
+
+    return;
+}
+
+/*
+ * Move a rigid body in small steps and compare the summed fusion output with the true motion.
+ */
+static void testRigidBody(double totalX, double totalY, double totalAngle, double mountAngle)
+{
+    PMW3360_fusion fusion;
+    PMW3360_motion motion;
+    PMW3360_data first = { 0 }, second = { 0 };
+    sensor a, b;
+    int64_t x = 0, y = 0, angle = 0;
+    int i;
+
+    sensor_init(&a, 12000, 0.0, -20000, 5000);
+    sensor_init(&b, 12000, mountAngle, 20000, -5000);
+    CHECK(PMW3360_fusion_init(&fusion, &a.mount, &b.mount, 0x10));
+
+    for (i = 0; i < FRAMES; i++) {
+        sensor_move(&a, totalX/FRAMES, totalY/FRAMES, totalAngle/FRAMES, &first);
+        sensor_move(&b, totalX/FRAMES, totalY/FRAMES, totalAngle/FRAMES, &second);
+        CHECK_EQ(PMW3360_fusion_update(&fusion, &first, &second, &motion), 0);
+        x += motion.dx;
+        y += motion.dy;
+        angle += motion.angle;
+    }
+
+    // Within a count of each sensor (2.1um at 12000 cpi), the rotation that count makes over the
+    // baseline and the Q14 rounding of the baseline normal
+    printf("expected (%.0f, %.0f, %.6f), got (%lld, %lld, %.6f)\n", totalX, totalY, totalAngle,
+           (long long)x, (long long)y, angle/65536.0);
+    CHECK(fabs(x - totalX) <= 4.0);
+    CHECK(fabs(y - totalY) <= 4.0);
+    CHECK(fabs(angle/65536.0 - totalAngle) <= 1e-4 + fabs(totalAngle)*1e-3);
+
+    return;
+}
+
+int main()
+{
+    testRigidBody(300.0, -200.0, 0.01, 0.0);
+    testRigidBody(300.0, -200.0, 0.01, M_PI/2);
+    testRigidBody(-300.0, 200.0, -0.01, -M_PI/4);
+    testRigidBody(5000.0, 0.0, 0.0, M_PI);
+    testRigidBody(0.0, 0.0, 0.2, 0.3);
+
+    return CHECK_RESULT();
+}
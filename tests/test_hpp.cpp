@@ -0,0 +1,60 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include "PMW3360.hpp"
+#include "observer.h"
+#include "check.h"
+
+// The same driver on each port policy, built once per port
+#if defined(__PICO_SDK__)
+using Sensor = pmw3360::PMW3360<pmw3360::PicoPort<0, 18, 19, 20, 21>>;
+#elif defined(__MSP430FR5994__)
+using Sensor = pmw3360::PMW3360<pmw3360::MSP430Port<BIT3>>;
+#endif
+
+int main()
+{
+    PMW3360_data data = {};
+    int padded = 0;
+
+    observer_reset();
+    CHECK(Sensor::init());
+
+    Sensor::read(data);
+    CHECK(data.motion);
+    CHECK_EQ(data.dx, 1);
+    CHECK_EQ(data.dy, 1);
+
+    Sensor::setDPI(1600);
+    CHECK_EQ(Sensor::getDPI(), 1600);
+    Sensor::setAngleSnap(true);
+    CHECK_EQ(observer_register(PMW3360_REG_ANGLE_SNAP), PMW3360_ANGLE_SNAP_EN);
+    Sensor::shutdown();
+
+    // Every transaction must meet the sensor's timing
+    CHECK_EQ(observer_report(&padded), 0);
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,233 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "PMW3360.h"
+#include "PMW3360_liftcal.h"
+#include "check.h"
+
+/*
+ * Register-level model of the sensor's lift cutoff tuning, standing in for
+ * the driver's register access. Tuning finishes after a number of status
+ * reads and leaves its results in Min_SQ_Run and Raw_Data_Threshold.
+ */
+static struct
+{
+    uint8_t regs[128];
+    bool written[128];
+    uint16_t tuneReads;         // Status reads until tuning finishes
+    uint8_t minSQRun;           // Tuning results
+    uint8_t rawDataThreshold;
+    uint32_t accesses;
+} sensor;
+
+static void sensor_reset(uint16_t tuneReads, uint8_t minSQRun, uint8_t rawDataThreshold)
+{
+    memset(&sensor, 0, sizeof(sensor));
+    sensor.regs[PMW3360_REG_LIFT_CONFIG] = 0x02;
+    sensor.regs[PMW3360_REG_MIN_SQ_RUN] = 0x00;
+    sensor.regs[PMW3360_REG_RAW_DATA_THRESHOLD] = 0x00;
+    sensor.tuneReads = tuneReads;
+    sensor.minSQRun = minSQRun;
+    sensor.rawDataThreshold = rawDataThreshold;
+
+    return;
+}
+
+uint8_t PMW3360_readRegister(uint8_t address)
+{
+    sensor.accesses++;
+    if (address == PMW3360_REG_LIFTCUTOFF_TUNE3 && (sensor.regs[address] & PMW3360_LIFTCAL_TUNE3_START)) {
+        if (sensor.tuneReads > 0 && --sensor.tuneReads == 0) {
+            sensor.regs[address] &= ~PMW3360_LIFTCAL_TUNE3_START;
+            sensor.regs[PMW3360_REG_MIN_SQ_RUN] = sensor.minSQRun;
+            sensor.regs[PMW3360_REG_RAW_DATA_THRESHOLD] = sensor.rawDataThreshold;
+            sensor.regs[PMW3360_REG_LIFT_CONFIG] = 0x03;
+        }
+    }
+
+    return sensor.regs[address & 0x7f];
+}
+
+void PMW3360_writeRegister(uint8_t address, uint8_t value)
+{
+    sensor.accesses++;
+    sensor.regs[address & 0x7f] = value;
+    sensor.written[address & 0x7f] = true;
+
+    return;
+}
+
+/*
+ * Step a calibration to its end, checking it never makes more than one access per step.
+ */
+static PMW3360_liftCalStatus run(PMW3360_liftCal *cal, uint16_t maxPolls)
+{
+    PMW3360_liftCalStatus status;
+    uint32_t before;
+    uint8_t progress = 0;
+
+    PMW3360_liftCal_start(cal, 0x10, 0x20, maxPolls);
+    CHECK_EQ(sensor.accesses, 0);
+    do {
+        before = sensor.accesses;
+        status = PMW3360_liftCal_step(cal);
+        CHECK(sensor.accesses - before <= 1);
+        if (status == PMW3360_LIFTCAL_RUNNING) {
+            CHECK(PMW3360_liftCal_progress(cal) >= progress);
+            CHECK(PMW3360_liftCal_progress(cal) < 100);
+            progress = PMW3360_liftCal_progress(cal);
+        }
+    } while (status == PMW3360_LIFTCAL_RUNNING);
+
+    return status;
+}
+
+static void testCalibration(void)
+{
+    PMW3360_liftCal cal;
+    PMW3360_liftTune tune;
+
+    sensor_reset(5, 0x25, 0x3c);
+    CHECK_EQ(run(&cal, 100), PMW3360_LIFTCAL_DONE);
+    CHECK_EQ(PMW3360_liftCal_progress(&cal), 100);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE_TIMEOUT], 0x10);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE_MIN_LENGTH], 0x20);
+
+    // The tuned values go to LiftCutoff_Tune1 and LiftCutoff_Tune2, the result registers are only read
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1], 0x80 | 0x25);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE2], 0x3c);
+    CHECK(!sensor.written[PMW3360_REG_MIN_SQ_RUN]);
+    CHECK(!sensor.written[PMW3360_REG_RAW_DATA_THRESHOLD]);
+
+    CHECK(PMW3360_liftCal_save(&cal, &tune));
+    CHECK_EQ(tune.liftConfig, 0x03);
+    CHECK_EQ(tune.minSQRun, 0x25);
+    CHECK_EQ(tune.rawDataThreshold, 0x3c);
+
+    // Restoring on a freshly reset sensor leaves the same tune registers as the calibration
+    sensor_reset(0, 0, 0);
+    PMW3360_liftCal_restore(&tune);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFT_CONFIG], 0x03);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1], 0x80 | 0x25);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE2], 0x3c);
+    CHECK(!sensor.written[PMW3360_REG_MIN_SQ_RUN]);
+    CHECK(!sensor.written[PMW3360_REG_RAW_DATA_THRESHOLD]);
+
+    return;
+}
+
+/*
+ * Sensor running an earlier calibration, which an unsuccessful one must leave in effect.
+ */
+static void sensor_calibrated(uint16_t tuneReads, uint8_t minSQRun, uint8_t rawDataThreshold)
+{
+    sensor_reset(tuneReads, minSQRun, rawDataThreshold);
+    sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1] = 0x80 | 0x19;
+    sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE2] = 0x2a;
+
+    return;
+}
+
+static void testTimeout(void)
+{
+    PMW3360_liftCal cal;
+    PMW3360_liftTune tune;
+
+    // Tuning never finishes, the calibration gives up and stops it on the sensor
+    sensor_reset(0, 0x25, 0x3c);
+    CHECK_EQ(run(&cal, 4), PMW3360_LIFTCAL_TIMEOUT);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE3], 0x00);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1], 0x00);
+    CHECK(!PMW3360_liftCal_save(&cal, &tune));
+
+    // An earlier calibration is put back
+    sensor_calibrated(0, 0x25, 0x3c);
+    CHECK_EQ(run(&cal, 4), PMW3360_LIFTCAL_TIMEOUT);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE3], 0x00);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1], 0x80 | 0x19);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE2], 0x2a);
+
+    return;
+}
+
+static void testFailed(void)
+{
+    PMW3360_liftCal cal;
+
+    // Tuning finishes without results, the manual cutoff stays off
+    sensor_reset(3, 0x00, 0x3c);
+    CHECK_EQ(run(&cal, 100), PMW3360_LIFTCAL_FAILED);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1], 0x00);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE2], 0x00);
+
+    // Or stays on with the earlier values
+    sensor_calibrated(3, 0x00, 0x3c);
+    CHECK_EQ(run(&cal, 100), PMW3360_LIFTCAL_FAILED);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1], 0x80 | 0x19);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE2], 0x2a);
+
+    return;
+}
+
+static void testAbort(void)
+{
+    PMW3360_liftCal cal;
+    int i;
+
+    // Aborted while polling, tuning stops and the earlier values are back
+    sensor_calibrated(0, 0x25, 0x3c);
+    PMW3360_liftCal_start(&cal, 0x10, 0x20, 100);
+    for (i = 0; i < 20; i++) {
+        PMW3360_liftCal_step(&cal);
+    }
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1], 0x00);
+    PMW3360_liftCal_abort(&cal);
+    CHECK_EQ(PMW3360_liftCal_step(&cal), PMW3360_LIFTCAL_IDLE);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE3], 0x00);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE1], 0x80 | 0x19);
+    CHECK_EQ(sensor.regs[PMW3360_REG_LIFTCUTOFF_TUNE2], 0x2a);
+
+    // Aborted before anything changed, nothing is written
+    sensor_calibrated(0, 0x25, 0x3c);
+    PMW3360_liftCal_start(&cal, 0x10, 0x20, 100);
+    PMW3360_liftCal_step(&cal);
+    PMW3360_liftCal_abort(&cal);
+    CHECK(!sensor.written[PMW3360_REG_LIFTCUTOFF_TUNE1]);
+    CHECK(!sensor.written[PMW3360_REG_LIFTCUTOFF_TUNE2]);
+
+    return;
+}
+
+int main()
+{
+    testCalibration();
+    testTimeout();
+    testFailed();
+    testAbort();
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,211 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <sched.h>
+
+#include "PMW3360.h"
+#include "PMW3360_pipeline.h"
+#include "observer.h"
+#include "check.h"
+
+// Steps run by the sensor thread, every simulated burst moves one count on both axes
+#define SAMPLES     20000
+
+typedef struct run
+{
+    PMW3360_pipeline pipeline;
+    atomic_bool done;               // Producer has published everything, including held back motion
+    uint32_t period;                // Period returned by the last step
+    uint32_t flushed;               // Idle samples pushed to publish held back motion
+    int64_t sumX;                   // Motion seen by the consumer
+    int64_t sumY;
+    uint32_t popped;
+    uint32_t outOfOrder;            // Samples whose timestamp did not increase
+} run;
+
+/*
+ * True when the ring has a free slot, so a push publishes instead of counting an overrun.
+ */
+static bool hasRoom(PMW3360_pipeline *pipeline)
+{
+    unsigned head = atomic_load_explicit(&pipeline->sampleHead, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&pipeline->sampleTail, memory_order_acquire);
+
+    return head - tail < PMW3360_PIPELINE_SIZE;
+}
+
+/*
+ * Sensor side, steps the pipeline against the simulated sensor then flushes any motion still held back.
+ */
+static void *producer(void *arg)
+{
+    run *r = arg;
+    PMW3360_data data = { 0 };
+    uint32_t i;
+
+    CHECK(PMW3360_pipeline_start(&r->pipeline));
+    for (i = 1; i <= SAMPLES; i++) {
+        r->period = PMW3360_pipeline_step(&r->pipeline, i);
+    }
+
+    // Idle samples carry whatever was coalesced during overruns, pushed only once there is room
+    while (r->pipeline.hasPending) {
+        if (hasRoom(&r->pipeline)) {
+            PMW3360_pipeline_push(&r->pipeline, &data, i++);
+            r->flushed++;
+        }
+        else {
+            sched_yield();
+        }
+    }
+    atomic_store_explicit(&r->done, true, memory_order_release);
+
+    return NULL;
+}
+
+/*
+ * Consumer side, changes the DPI and period then pauses now and then so the ring fills up and samples are coalesced.
+ */
+static void *consumer(void *arg)
+{
+    static const struct timespec pause = { 0, 20000 };
+    run *r = arg;
+    PMW3360_sample sample;
+    uint32_t last = 0;
+    bool done;
+
+    CHECK(PMW3360_pipeline_command(&r->pipeline, PMW3360_PIPELINE_CMD_DPI, 1600));
+    CHECK(PMW3360_pipeline_command(&r->pipeline, PMW3360_PIPELINE_CMD_PERIOD, 500));
+    do {
+        done = atomic_load_explicit(&r->done, memory_order_acquire);
+        while (PMW3360_pipeline_pop(&r->pipeline, &sample)) {
+            if (sample.timestamp <= last) {
+                r->outOfOrder++;
+            }
+            last = sample.timestamp;
+            r->sumX += sample.data.dx;
+            r->sumY += sample.data.dy;
+            if (++r->popped % 256 == 0) {
+                nanosleep(&pause, NULL);
+            }
+        }
+    } while (!done);
+
+    return NULL;
+}
+
+/*
+ * Samples come out in order, commands reach the sensor and coalescing under overruns keeps the total motion.
+ */
+static void testThreads(void)
+{
+    static run r;
+    pthread_t p, c;
+    uint32_t overruns;
+
+    observer_reset();
+    PMW3360_pipeline_init(&r.pipeline, 1000);
+    atomic_init(&r.done, false);
+
+    CHECK(pthread_create(&c, NULL, consumer, &r) == 0);
+    CHECK(pthread_create(&p, NULL, producer, &r) == 0);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+
+    overruns = PMW3360_pipeline_overruns(&r.pipeline);
+    printf("popped %lu of %lu, overruns %lu\n", (unsigned long)r.popped, (unsigned long)SAMPLES,
+           (unsigned long)overruns);
+    CHECK_EQ(r.outOfOrder, 0);
+    CHECK_EQ(PMW3360_pipeline_readErrors(&r.pipeline), 0);
+    CHECK_EQ(r.sumX, SAMPLES);
+    CHECK_EQ(r.sumY, SAMPLES);
+
+    // Every step either published a sample or counted exactly one overrun, flushes never overrun
+    CHECK(overruns > 0);
+    CHECK_EQ(r.popped + overruns, SAMPLES + r.flushed);
+
+    // Both commands were applied by the sensor thread
+    CHECK_EQ(observer_register(PMW3360_REG_CONFIG1), 1600 / 100 - 1);
+    CHECK_EQ(r.period, 500);
+
+    PMW3360_shutdown();
+
+    return;
+}
+
+/*
+ * Coalesced motion beyond 16 bits is carried into later samples, not clipped.
+ */
+static void testOverflow(void)
+{
+    static PMW3360_pipeline pipeline;
+    PMW3360_data data = { 0 };
+    PMW3360_sample sample;
+    int32_t sumX = 0, sumY = 0;
+    uint32_t timestamp = 0;
+    int i;
+
+    PMW3360_pipeline_init(&pipeline, 1000);
+
+    // Fill the ring, then keep pushing fast motion with nobody consuming
+    for (i = 0; i < PMW3360_PIPELINE_SIZE; i++) {
+        CHECK(PMW3360_pipeline_push(&pipeline, &data, timestamp++));
+    }
+    data.motion = true;
+    data.dx = 30000;
+    data.dy = -30000;
+    for (i = 0; i < 10; i++) {
+        CHECK(!PMW3360_pipeline_push(&pipeline, &data, timestamp++));
+    }
+    CHECK_EQ(PMW3360_pipeline_overruns(&pipeline), 10);
+
+    // Drain, idle samples publish the remainder one 16-bit step at a time
+    data.motion = false;
+    data.dx = 0;
+    data.dy = 0;
+    for (i = 0; i < 100; i++) {
+        while (PMW3360_pipeline_pop(&pipeline, &sample)) {
+            sumX += sample.data.dx;
+            sumY += sample.data.dy;
+        }
+        PMW3360_pipeline_push(&pipeline, &data, timestamp++);
+    }
+    CHECK(!pipeline.hasPending);
+    CHECK_EQ(sumX, 300000);
+    CHECK_EQ(sumY, -300000);
+
+    return;
+}
+
+int main()
+{
+    testOverflow();
+    testThreads();
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,128 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_profile.h"
+#include "PMW3360_liftcal.h"
+#include "observer.h"
+#include "check.h"
+
+/*
+ * Every register a profile sets must hold the profile's value on the sensor.
+ */
+static void checkProfile(const PMW3360_profile *profile)
+{
+    CHECK_EQ(observer_register(PMW3360_REG_CONFIG1), profile->dpi/100 - 1);
+    CHECK_EQ(observer_register(PMW3360_REG_LIFT_CONFIG), profile->liftConfig);
+    CHECK_EQ(observer_register(PMW3360_REG_RUN_DOWNSHIFT), profile->runDownshift);
+    CHECK_EQ(observer_register(PMW3360_REG_REST1_DOWNSHIFT), profile->rest1Downshift);
+    CHECK_EQ(observer_register(PMW3360_REG_REST2_RATE_LOWER), profile->rest2Rate & 0xff);
+    CHECK_EQ(observer_register(PMW3360_REG_REST3_RATE_UPPER), profile->rest3Rate >> 8);
+    CHECK_EQ(observer_register(PMW3360_REG_CONFIG2), profile->rest ? PMW3360_CONFIG2_REST_EN : 0x00);
+
+    return;
+}
+
+int main()
+{
+    static const PMW3360_profile standard = PMW3360_PROFILE_DEFAULT;
+    static const PMW3360_profile gaming = { 1600, 0, false, 0x02, false, 0x32, 0x0000, 0x1f, 0x0063, 0xbc, 0x01f3 };
+    static const PMW3360_profile office = { 800, 0, false, 0x03, true, 0x10, 0x0001, 0x1f, 0x0063, 0xbc, 0x01f3 };
+    PMW3360_snapshot snapshot;
+    PMW3360_data data;
+    uint32_t writes, loads, latency, uploaded;
+    uint64_t start;
+
+    observer_reset();
+    CHECK(PMW3360_init());
+
+    // The default profile is what init and the power-up values leave behind, nothing to write
+    writes = observer_writes();
+    CHECK(PMW3360_profile_apply(&standard, PMW3360_WRITE_VERIFY));
+    CHECK_EQ(observer_writes() - writes, 0);
+    checkProfile(&standard);
+
+    // Profiles differing in one setting cost one write, in either direction
+    writes = observer_writes();
+    CHECK(PMW3360_profile_apply(&gaming, PMW3360_WRITE_VERIFY));
+    CHECK_EQ(observer_writes() - writes, 1);
+    checkProfile(&gaming);
+    writes = observer_writes();
+    CHECK(PMW3360_profile_apply(&standard, 0));
+    CHECK_EQ(observer_writes() - writes, 1);
+
+    // Lift, run downshift, Rest1 rate lower and Config2
+    writes = observer_writes();
+    CHECK(PMW3360_profile_apply(&office, PMW3360_WRITE_VERIFY));
+    CHECK_EQ(observer_writes() - writes, 4);
+    checkProfile(&office);
+
+    // Forcing writes the whole profile
+    writes = observer_writes();
+    CHECK(PMW3360_profile_apply(&office, PMW3360_WRITE_FORCE));
+    CHECK_EQ(observer_writes() - writes, 14);
+
+    // A finished lift calibration leaves its threshold in Tune2 and enables it in Tune1
+    PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE2, 0x2a);
+    PMW3360_writeRegister(PMW3360_REG_LIFTCUTOFF_TUNE1, PMW3360_LIFTCAL_TUNE1_ENABLE | 0x19);
+
+    // Resume replays only what differs from the power-up values. The simulated sensor loses its firmware, so this
+    // is the reset, three upload writes, Config1, the profile's three changes, both lift tunes, Config2 and the burst start
+    PMW3360_suspend(&snapshot);
+    writes = observer_writes();
+    loads = observer_sromLoads();
+    start = observer_now();
+    CHECK(PMW3360_resume(&snapshot, &data, &latency));
+    CHECK_EQ(observer_writes() - writes, 12);
+    CHECK_EQ(observer_sromLoads() - loads, 1);
+    CHECK_EQ(observer_register(PMW3360_REG_LIFTCUTOFF_TUNE2), 0x2a);
+    CHECK_EQ(observer_register(PMW3360_REG_LIFTCUTOFF_TUNE1), PMW3360_LIFTCAL_TUNE1_ENABLE | 0x19);
+    checkProfile(&office);
+    CHECK(data.motion);
+
+    // The reported latency is the time the resume took, most of it the firmware upload
+    uploaded = latency;
+    CHECK(latency <= (observer_now() - start)/1000 && latency + 1 >= (observer_now() - start)/1000);
+
+    // A sensor that kept its firmware is not uploaded again, which saves most of the latency
+    observer_keepFirmware(true);
+    PMW3360_suspend(&snapshot);
+    writes = observer_writes();
+    loads = observer_sromLoads();
+    start = observer_now();
+    CHECK(PMW3360_resume(&snapshot, &data, &latency));
+    CHECK_EQ(observer_writes() - writes, 9);
+    CHECK_EQ(observer_sromLoads() - loads, 0);
+    CHECK_EQ(observer_register(PMW3360_REG_LIFTCUTOFF_TUNE2), 0x2a);
+    CHECK_EQ(observer_register(PMW3360_REG_LIFTCUTOFF_TUNE1), PMW3360_LIFTCAL_TUNE1_ENABLE | 0x19);
+    checkProfile(&office);
+    CHECK(data.motion);
+    CHECK(latency <= (observer_now() - start)/1000 && latency + 1 >= (observer_now() - start)/1000);
+    printf("resume latency %lu us with upload, %lu us without\n", (unsigned long)uploaded, (unsigned long)latency);
+    CHECK(latency + 50000 < uploaded);
+
+    return CHECK_RESULT();
+}
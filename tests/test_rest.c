@@ -0,0 +1,200 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "PMW3360.h"
+#include "PMW3360_profile.h"
+#include "PMW3360_rest.h"
+#include "observer.h"
+#include "check.h"
+
+// Idle gaps in a synthetic session
+#define GAPS        400
+
+// Resolution and lift distance set after init, which differ from the base profile the tuner is given
+#define DPI         3200
+#define LIFT        0x03
+
+// Share of gaps allowed to wake slower than the bound, the tuner works on bucket means so allow a little over
+#define SLOW_LIMIT  (100 - PMW3360_REST_PERCENTILE + 1)
+
+/*
+ * Desk use: short pauses between strokes, longer ones while typing, and a rare walk away.
+ */
+static void session(uint32_t *gaps, uint32_t *seed)
+{
+    uint32_t r;
+    int i;
+
+    for (i = 0; i < GAPS; i++) {
+        *seed = *seed*1103515245u + 12345u;
+        r = *seed >> 16;
+        if (r % 200 == 0) {
+            gaps[i] = 30000 + r % 30000;
+        }
+        else if (r % 4 == 0) {
+            gaps[i] = 1000 + r % 4000;
+        }
+        else {
+            gaps[i] = 50 + r % 450;
+        }
+    }
+
+    return;
+}
+
+/*
+ * Mode an idle gap ends in under a profile and its frame period, the same model the datasheet gives.
+ */
+static uint32_t wakePeriod(const PMW3360_profile *profile, uint32_t gap, uint64_t *charge)
+{
+    uint32_t period[4], limit[3], current;
+    uint8_t mode;
+
+    period[0] = 0;
+    period[1] = (uint32_t)profile->rest1Rate + 1;
+    period[2] = (uint32_t)profile->rest2Rate + 1;
+    period[3] = (uint32_t)profile->rest3Rate + 1;
+    limit[0] = (uint32_t)profile->runDownshift*10;
+    limit[1] = (uint32_t)profile->rest1Downshift*320*period[1];
+    limit[2] = (uint32_t)profile->rest2Downshift*32*period[2];
+    if (!profile->rest) {
+        *charge += (uint64_t)gap*PMW3360_REST_RUN_CURRENT;
+        return 0;
+    }
+
+    for (mode = 0; mode < 3 && gap > limit[mode]; mode++) {
+        current = mode == 0 ? PMW3360_REST_RUN_CURRENT : PMW3360_REST_FLOOR_CURRENT + PMW3360_REST_FRAME_CHARGE/period[mode];
+        *charge += (uint64_t)limit[mode]*current;
+        gap -= limit[mode];
+    }
+    current = mode == 0 ? PMW3360_REST_RUN_CURRENT : PMW3360_REST_FLOOR_CURRENT + PMW3360_REST_FRAME_CHARGE/period[mode];
+    *charge += (uint64_t)gap*current;
+
+    return period[mode];
+}
+
+/*
+ * Play a session at one sample per millisecond, then replay its raw gaps against the tuned profile.
+ */
+static void testSession(uint16_t latency, uint32_t seed)
+{
+    static const PMW3360_profile base = PMW3360_PROFILE_DEFAULT;
+    static uint32_t gaps[GAPS];
+    PMW3360_rest rest;
+    PMW3360_data data = { 0 };
+    uint64_t tuned = 0, run = 0;
+    uint32_t t = 0, end, slow = 0, rewrites = 0;
+    int i;
+
+    session(gaps, &seed);
+    PMW3360_rest_init(&rest, &base, latency, 10000);
+    for (i = 0; i < GAPS; i++) {
+        // A stroke of 100 ms, then the gap
+        for (end = t + 100; t < end; t++) {
+            data.motion = true;
+            rewrites += PMW3360_rest_update(&rest, &data, t);
+        }
+        for (end = t + gaps[i]; t < end; t++) {
+            data.motion = false;
+            rewrites += PMW3360_rest_update(&rest, &data, t);
+        }
+    }
+    data.motion = true;
+    rewrites += PMW3360_rest_update(&rest, &data, t);
+
+    for (i = 0; i < GAPS; i++) {
+        slow += wakePeriod(&rest.profile, gaps[i], &tuned) > latency;
+        wakePeriod(&base, gaps[i], &run);
+    }
+    printf("latency %u ms: %lu rewrites, run %u rest1 %u/%u, %lu of %d gaps slow, %.1f%% of run mode charge\n",
+           latency, (unsigned long)rewrites, rest.profile.runDownshift, rest.profile.rest1Rate,
+           rest.profile.rest1Downshift, (unsigned long)slow, GAPS, 100.0*tuned/run);
+
+    CHECK(rewrites > 0);
+    CHECK(rest.profile.rest);
+    CHECK(slow*100 <= GAPS*SLOW_LIMIT);
+    CHECK(tuned*2 < run);
+
+    // The sensor holds what the tuner chose
+    CHECK_EQ(observer_register(PMW3360_REG_RUN_DOWNSHIFT), rest.profile.runDownshift);
+    CHECK_EQ(observer_register(PMW3360_REG_REST1_DOWNSHIFT), rest.profile.rest1Downshift);
+    CHECK_EQ(observer_register(PMW3360_REG_REST1_RATE_LOWER), rest.profile.rest1Rate & 0xff);
+    CHECK_EQ(observer_register(PMW3360_REG_CONFIG2), PMW3360_CONFIG2_REST_EN);
+
+    // Settings made outside the tuner survive every retune
+    CHECK_EQ(observer_register(PMW3360_REG_CONFIG1), DPI/100 - 1);
+    CHECK_EQ(observer_register(PMW3360_REG_LIFT_CONFIG), LIFT);
+
+    return;
+}
+
+/*
+ * Idle samples before the first motion do not make a gap, however late the motion comes.
+ */
+static void testFirstMotion(void)
+{
+    static const PMW3360_profile base = PMW3360_PROFILE_DEFAULT;
+    PMW3360_rest rest;
+    PMW3360_data data = { 0 };
+    uint32_t t;
+    uint8_t k;
+
+    PMW3360_rest_init(&rest, &base, 10, 1000);
+    for (t = 3600000; t < 3601000; t++) {
+        PMW3360_rest_update(&rest, &data, t);
+    }
+    data.motion = true;
+    PMW3360_rest_update(&rest, &data, t);
+    CHECK_EQ(rest.gaps, 0);
+
+    // The next gap is timed from that motion, 100 ms falls in the 64-127 ms bucket
+    data.motion = false;
+    PMW3360_rest_update(&rest, &data, t + 1);
+    data.motion = true;
+    PMW3360_rest_update(&rest, &data, t + 100);
+    CHECK_EQ(rest.gaps, 1);
+    for (k = 0; k < PMW3360_REST_BUCKETS; k++) {
+        CHECK_EQ(rest.count[k], (k == 6 ? 1 : 0));
+    }
+
+    return;
+}
+
+int main()
+{
+    observer_reset();
+    CHECK(PMW3360_init());
+    PMW3360_setDPI(DPI);
+    PMW3360_writeRegister(PMW3360_REG_LIFT_CONFIG, LIFT);
+
+    testFirstMotion();
+    testSession(20, 1);
+    testSession(5, 2);
+    testSession(2, 3);
+
+    return CHECK_RESULT();
+}
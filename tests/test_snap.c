@@ -0,0 +1,152 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_snap.h"
+#include "check.h"
+
+/*
+ * Feed a constant motion n times, returns the axis of the last sample and the total output.
+ */
+static uint8_t feed(PMW3360_snap *snap, int16_t dx, int16_t dy, int n, int32_t *sumX, int32_t *sumY)
+{
+    PMW3360_data data = { 0 };
+    uint8_t axis = PMW3360_SNAP_FREE;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        data.motion = dx != 0 || dy != 0;
+        data.dx = dx;
+        data.dy = dy;
+        axis = PMW3360_snap_apply(snap, &data);
+        *sumX += data.dx;
+        *sumY += data.dy;
+    }
+
+    return axis;
+}
+
+static void init(PMW3360_snap *snap)
+{
+    PMW3360_snap_init(snap, PMW3360_SNAP_ENTER_DEFAULT, PMW3360_SNAP_EXIT_DEFAULT, PMW3360_SNAP_TRAVEL_DEFAULT);
+
+    return;
+}
+
+/*
+ * Diagonal strokes in every quadrant never lock and pass through untouched.
+ */
+static void testDiagonal(void)
+{
+    static const int16_t signs[4][2] = { { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+    PMW3360_snap snap;
+    int32_t x, y;
+    uint8_t i;
+
+    for (i = 0; i < 4; i++) {
+        init(&snap);
+        x = 0;
+        y = 0;
+        CHECK_EQ(feed(&snap, 7*signs[i][0], 5*signs[i][1], 500, &x, &y), PMW3360_SNAP_FREE);
+        CHECK_EQ(x, 3500*signs[i][0]);
+        CHECK_EQ(y, 2500*signs[i][1]);
+    }
+
+    return;
+}
+
+/*
+ * A stroke a few degrees off an axis locks once it has travelled far enough, then drops its drift.
+ */
+static void testNearAxis(void)
+{
+    PMW3360_snap snap;
+    PMW3360_data data = { 0 };
+    int32_t x = 0, y = 0;
+    int i;
+
+    // About 3 degrees off x: dy is 1 every other sample on dx of 10
+    init(&snap);
+    for (i = 0; i < 400; i++) {
+        data.motion = true;
+        data.dx = -10;
+        data.dy = (int16_t)(i & 1);
+        PMW3360_snap_apply(&snap, &data);
+        x += data.dx;
+        y += data.dy;
+
+        // Not enough travel to lock on the first samples
+        if (i == 0) {
+            CHECK_EQ(snap.axis, PMW3360_SNAP_FREE);
+        }
+    }
+    CHECK_EQ(snap.axis, PMW3360_SNAP_X);
+    CHECK_EQ(x, -4000);
+    CHECK(y <= 2);
+
+    // The same stroke turned onto y locks the other axis
+    init(&snap);
+    x = 0;
+    y = 0;
+    CHECK_EQ(feed(&snap, 0, 12, 4, &x, &y), PMW3360_SNAP_Y);
+    CHECK_EQ(feed(&snap, 1, 12, 100, &x, &y), PMW3360_SNAP_Y);
+    CHECK_EQ(x, 0);
+    CHECK_EQ(y, 1248);
+
+    return;
+}
+
+/*
+ * Between the enter and exit ratios the lock holds if engaged and stays off if not.
+ */
+static void testHysteresis(void)
+{
+    PMW3360_snap snap;
+    int32_t x = 0, y = 0;
+
+    // 5 on 20 is a ratio of 64, between 45 and 93
+    init(&snap);
+    CHECK_EQ(feed(&snap, 20, 5, 200, &x, &y), PMW3360_SNAP_FREE);
+
+    init(&snap);
+    CHECK_EQ(feed(&snap, 20, 0, 20, &x, &y), PMW3360_SNAP_X);
+    CHECK_EQ(feed(&snap, 20, 5, 200, &x, &y), PMW3360_SNAP_X);
+
+    // Pauses keep the lock, turning to a diagonal releases it within a window
+    CHECK_EQ(feed(&snap, 0, 0, 50, &x, &y), PMW3360_SNAP_X);
+    CHECK_EQ(feed(&snap, 10, 10, PMW3360_SNAP_WINDOW, &x, &y), PMW3360_SNAP_FREE);
+
+    return;
+}
+
+int main()
+{
+    testDiagonal();
+    testNearAxis();
+    testHysteresis();
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,88 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_pipeline.h"
+#include "observer.h"
+#include "check.h"
+
+int main()
+{
+    static const PMW3360_regValue dpi[] = {
+        { PMW3360_REG_CONFIG1, 0x10 },
+    };
+    static PMW3360_pipeline pipeline;
+    PMW3360_data data;
+    PMW3360_sample sample;
+    uint32_t writes;
+
+    // The device can not be opened
+    observer_reset();
+    sim_linux_fault(1, -1);
+    CHECK(!PMW3360_init());
+
+    // Healthy bus
+    sim_linux_fault(0, -1);
+    CHECK(PMW3360_init());
+    CHECK(PMW3360_read(&data));
+    CHECK(data.motion);
+    CHECK_EQ(data.dx, 1);
+
+    // Every message fails: reads report it and return no motion or zero instead of stale buffers
+    sim_linux_fault(0, 0);
+    data.motion = true;
+    data.dx = 77;
+    data.dy = -77;
+    CHECK(!PMW3360_read(&data));
+    CHECK(!data.motion);
+    CHECK_EQ(data.dx, 0);
+    CHECK_EQ(data.dy, 0);
+    CHECK(!PMW3360_readMotion(&data));
+    CHECK_EQ(PMW3360_readRegister(PMW3360_REG_PRODUCT_ID), 0);
+
+    // A pipeline step on the failing bus pushes nothing and counts the error
+    PMW3360_pipeline_init(&pipeline, 1000);
+    PMW3360_pipeline_step(&pipeline, 1);
+    CHECK(!PMW3360_pipeline_pop(&pipeline, &sample));
+    CHECK_EQ(PMW3360_pipeline_readErrors(&pipeline), 1);
+
+    // A failed write leaves the register unknown, so the same value is written again once the bus recovers
+    PMW3360_writeRegister(PMW3360_REG_CONFIG1, 0x10);
+    sim_linux_fault(0, -1);
+    writes = observer_writes();
+    CHECK(PMW3360_writeRegisters(dpi, 1, PMW3360_WRITE_VERIFY));
+    CHECK_EQ(observer_writes() - writes, 1);
+    CHECK(PMW3360_read(&data));
+
+    // The bus fails in the middle of the firmware upload
+    PMW3360_shutdown();
+    sim_linux_fault(0, 8);
+    CHECK(!PMW3360_init());
+
+    PMW3360_shutdown();
+
+    return CHECK_RESULT();
+}
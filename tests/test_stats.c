@@ -0,0 +1,211 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "PMW3360.h"
+#include "PMW3360_stats.h"
+#include "check.h"
+
+/*
+ * Feed n identical samples, returns the flags of the last one.
+ */
+static uint8_t feed(PMW3360_stats *stats, bool surface, uint8_t squal, uint16_t shutter, uint8_t contrast, int n)
+{
+    PMW3360_data data = { 0 };
+    uint8_t flags = 0;
+    int i;
+
+    data.surface = surface;
+    data.SQUAL = squal;
+    data.shutter = shutter;
+    data.minRawData = 40;
+    data.maxRawData = (uint8_t)(40 + contrast);
+    for (i = 0; i < n; i++) {
+        flags = PMW3360_stats_update(stats, &data);
+    }
+
+    return flags;
+}
+
+/*
+ * A good surface raises nothing, lifting raises only the lift flag.
+ */
+static void testLift(void)
+{
+    PMW3360_stats stats;
+
+    PMW3360_stats_init(&stats, 1);
+    CHECK_EQ(feed(&stats, true, 60, 100, 80, 100), 0);
+    CHECK_EQ(stats.meanSQUAL >> 8, 60);
+    CHECK_EQ(stats.varSQUAL, 0);
+    CHECK_EQ(feed(&stats, false, 60, 100, 80, 1), PMW3360_STATS_LIFT);
+    CHECK_EQ(feed(&stats, true, 60, 100, 80, 1), 0);
+
+    return;
+}
+
+/*
+ * A sudden SQUAL drop on the surface is a partial lift, noise around the mean is not.
+ */
+static void testPartialLift(void)
+{
+    PMW3360_stats stats;
+    PMW3360_data data = { 0 };
+    uint8_t flags = 0;
+    int i;
+
+    PMW3360_stats_init(&stats, 1);
+    feed(&stats, true, 60, 100, 80, 100);
+
+    // Each sample adds about 60 - 30 - drift, the limit is crossed on the third
+    CHECK_EQ(feed(&stats, true, 30, 100, 80, 1), 0);
+    CHECK_EQ(feed(&stats, true, 30, 100, 80, 1), 0);
+    CHECK_EQ(feed(&stats, true, 30, 100, 80, 1), PMW3360_STATS_PARTIAL_LIFT);
+
+    // Back on the surface the sum drains and the flag clears
+    CHECK_EQ(feed(&stats, true, 60, 100, 80, 50), 0);
+    CHECK_EQ(stats.cusum, 0);
+
+    // Noise of a few counts stays under the drift
+    data.surface = true;
+    data.shutter = 100;
+    data.minRawData = 40;
+    data.maxRawData = 120;
+    for (i = 0; i < 2000; i++) {
+        data.SQUAL = (uint8_t)(57 + (i*5) % 7);
+        flags |= PMW3360_stats_update(&stats, &data);
+    }
+    CHECK_EQ(flags, 0);
+
+    return;
+}
+
+/*
+ * A low mean SQUAL flags the surface, a slowly fading contrast flags the optics.
+ */
+static void testSurfaceAndOptics(void)
+{
+    PMW3360_stats stats;
+
+    PMW3360_stats_init(&stats, 1);
+    CHECK_EQ(feed(&stats, true, 10, 100, 80, 1), PMW3360_STATS_BAD_SURFACE);
+
+    // The contrast average is slow, a short dip does not flag the optics
+    PMW3360_stats_init(&stats, 1);
+    feed(&stats, true, 60, 100, 80, 100);
+    CHECK_EQ(feed(&stats, true, 60, 100, 4, 10), 0);
+    CHECK_EQ(feed(&stats, true, 60, 100, 4, 2000), PMW3360_STATS_DIRTY_OPTICS);
+
+    // Lifted frames have no contrast and must not count
+    PMW3360_stats_init(&stats, 1);
+    feed(&stats, true, 60, 100, 80, 100);
+    CHECK_EQ(feed(&stats, false, 60, 100, 0, 2000), PMW3360_STATS_LIFT);
+
+    return;
+}
+
+/*
+ * With an interval only every interval-th sample is due, 0 means every sample.
+ */
+static void testInterval(void)
+{
+    PMW3360_stats stats;
+    int i;
+
+    PMW3360_stats_init(&stats, 4);
+    for (i = 0; i < 12; i++) {
+        CHECK_EQ(PMW3360_stats_due(&stats), i % 4 == 0);
+    }
+
+    PMW3360_stats_init(&stats, 0);
+    for (i = 0; i < 4; i++) {
+        CHECK(PMW3360_stats_due(&stats));
+    }
+
+    return;
+}
+
+/*
+ * The report holds the fields little-endian at the documented offsets.
+ */
+static void testReport(void)
+{
+    PMW3360_stats stats;
+    PMW3360_data data = { 0 };
+    uint8_t report[PMW3360_STATS_REPORT_SIZE];
+    int i;
+
+    PMW3360_stats_init(&stats, 1);
+    CHECK_EQ(feed(&stats, true, 60, 0x1234, 160, 1), 0);
+    PMW3360_stats_report(&stats, report);
+    CHECK_EQ(report[0], 0);
+    CHECK_EQ(report[1], 60);
+    CHECK_EQ(report[2], 60);
+    CHECK_EQ(report[3] | report[4] << 8, 60 << 8);
+    CHECK_EQ(report[5] | report[6] << 8, 0);
+    CHECK_EQ(report[7] | report[8] << 8, 0x1234);
+    CHECK_EQ(report[9] | report[10] << 8, 0);
+    CHECK_EQ(report[11] | report[12] << 8, 0x1234);
+    CHECK_EQ(report[13] | report[14] << 8, 160 << 8);
+    CHECK_EQ(report[15], 0);
+
+    // Varying samples, every field must match the statistics it reports
+    data.surface = true;
+    data.minRawData = 20;
+    for (i = 0; i < 300; i++) {
+        data.SQUAL = (uint8_t)(40 + (i*37) % 50);
+        data.shutter = (uint16_t)(200 + (i*91) % 700);
+        data.maxRawData = (uint8_t)(60 + (i*13) % 100);
+        PMW3360_stats_update(&stats, &data);
+    }
+    data.surface = false;
+    PMW3360_stats_update(&stats, &data);
+    PMW3360_stats_report(&stats, report);
+    CHECK_EQ(report[0], stats.flags);
+    CHECK_EQ(report[0], PMW3360_STATS_LIFT);
+    CHECK_EQ(report[1], 40);
+    CHECK_EQ(report[2], 89);
+    CHECK_EQ(report[3] | report[4] << 8, stats.meanSQUAL);
+    CHECK_EQ(report[5] | report[6] << 8, stats.varSQUAL);
+    CHECK(stats.varSQUAL > 0);
+    CHECK_EQ(report[7] | report[8] << 8, stats.meanShutter >> 4);
+    CHECK_EQ(report[9] | report[10] << 8, stats.varShutter >> 8);
+    CHECK(stats.varShutter >> 8 > 0);
+    CHECK_EQ(report[11] | report[12] << 8, stats.maxShutter);
+    CHECK_EQ(report[13] | report[14] << 8, stats.contrast);
+
+    return;
+}
+
+int main()
+{
+    testLift();
+    testPartialLift();
+    testSurfaceAndOptics();
+    testInterval();
+    testReport();
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# MIT License
+#
+# Copyright (c) 2023 Brent Peterson
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Generate src/PMW3360_accel.h, the fixed-point acceleration curve tables.
+
+Each table maps a speed index (0..PMW3360_ACCEL_LUT_SIZE-1) to a gain in Q8.8
+fixed point (256 = 1.0). Edit the curve parameters below and re-run:
+
+    python3 tools/gen_accel_lut.py > src/PMW3360_accel.h
+"""
+
+import math
+
+LUT_SIZE = 64
+
+# Gain at zero speed and at the top of the table for every curve
+GAIN_MIN = 1.0
+GAIN_MAX = 3.0
+
+# Exponent of the power curve
+POWER_EXPONENT = 1.5
+
+# Steepness and midpoint (fraction of the table) of the sigmoid curve
+SIGMOID_STEEPNESS = 12.0
+SIGMOID_MIDPOINT = 0.5
+
+
+def linear(v):
+    return GAIN_MIN + (GAIN_MAX - GAIN_MIN) * v
+
+
+def power(v):
+    return GAIN_MIN + (GAIN_MAX - GAIN_MIN) * v ** POWER_EXPONENT
+
+
+def sigmoid(v):
+    lo = 1.0 / (1.0 + math.exp(SIGMOID_STEEPNESS * SIGMOID_MIDPOINT))
+    hi = 1.0 / (1.0 + math.exp(-SIGMOID_STEEPNESS * (1.0 - SIGMOID_MIDPOINT)))
+    s = 1.0 / (1.0 + math.exp(-SIGMOID_STEEPNESS * (v - SIGMOID_MIDPOINT)))
+    return GAIN_MIN + (GAIN_MAX - GAIN_MIN) * (s - lo) / (hi - lo)
+
+
+def table(name, curve):
+    values = [int(round(curve(i / (LUT_SIZE - 1)) * 256)) for i in range(LUT_SIZE)]
+    lines = ["static const uint16_t %s[PMW3360_ACCEL_LUT_SIZE] = {" % name]
+    for i in range(0, LUT_SIZE, 8):
+        lines.append("    " + ", ".join("0x%04x" % v for v in values[i:i + 8]) + ",")
+    lines[-1] = lines[-1].rstrip(",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    with open(__file__) as f:
+        license_lines = []
+        for line in f.readlines()[1:]:
+            if not line.startswith("#"):
+                break
+            license_lines.append(line[2:].rstrip())
+
+    print("/* " + license_lines[0])
+    for line in license_lines[1:]:
+        print((" * " + line).rstrip())
+    print(" */")
+    print()
+    print("/*")
+    print(" * Generated by tools/gen_accel_lut.py, do not edit.")
+    print(" */")
+    print()
+    print("#ifndef PMW3360_ACCEL_H__")
+    print("#define PMW3360_ACCEL_H__")
+    print()
+    print("#include <stdint.h>")
+    print()
+    print("#define PMW3360_ACCEL_LUT_SIZE                      %d" % LUT_SIZE)
+    print()
+    print(table("PMW3360_accelLinear", linear))
+    print()
+    print(table("PMW3360_accelPower", power))
+    print()
+    print(table("PMW3360_accelSigmoid", sigmoid))
+    print()
+    print("#endif //PMW3360_ACCEL_H__")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,129 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "PMW3360.h"
+#include "observer.h"
+
+// Samples read to measure the read rate
+#define READS       1000
+
+int main()
+{
+    static const PMW3360_regValue table[] = {
+        { PMW3360_REG_CONFIG1, 0x0f },
+        { PMW3360_REG_ANGLE_TUNE, 0x05 },
+        { PMW3360_REG_LIFT_CONFIG, 0x03 },
+    };
+    PMW3360_data data;
+    uint64_t start, init, read, readMotion;
+    uint16_t i;
+    int failed;
+    int padded = 0;
+#if PMW3360_SENSOR_COUNT > 1
+    PMW3360_data second;
+    uint64_t readPair;
+    uint16_t unlatched = 0;
+#endif
+#if PMW3360_ENABLE_FRAME_CAPTURE
+    static uint8_t frame[PMW3360_FRAME_SIZE];
+#endif
+
+    observer_reset();
+
+    // Power up and upload the firmware
+    start = observer_now();
+    if (!PMW3360_init()) {
+        printf("PMW3360_init failed, the simulated sensor did not accept the firmware\n");
+        return 1;
+    }
+    init = observer_now() - start;
+
+#if PMW3360_SENSOR_COUNT > 1
+    // The second sensor on its own chip select, every rule is checked on both lines
+    PMW3360_select(1);
+    if (!PMW3360_init()) {
+        printf("PMW3360_init failed on the second sensor\n");
+        return 1;
+    }
+    PMW3360_select(0);
+#endif
+
+    // Back to back reads, the rate is bounded by the bus and the delays the port adds
+    start = observer_now();
+    for (i = 0; i < READS; i++) {
+        PMW3360_read(&data);
+    }
+    read = observer_now() - start;
+    start = observer_now();
+    for (i = 0; i < READS; i++) {
+        PMW3360_readMotion(&data);
+    }
+    readMotion = observer_now() - start;
+#if PMW3360_SENSOR_COUNT > 1
+    // Paired reads, the simulated sensors only report motion after their own Motion_Burst write
+    start = observer_now();
+    for (i = 0; i < READS; i++) {
+        if (!PMW3360_readPair(&data, &second) || !data.motion || !second.motion) {
+            unlatched++;
+        }
+    }
+    readPair = observer_now() - start;
+#endif
+
+    // Register writes, verified read backs and the remaining transaction kinds
+    PMW3360_setDPI(1600);
+    PMW3360_writeRegisters(table, sizeof(table)/sizeof(table[0]), PMW3360_WRITE_VERIFY);
+#if PMW3360_ENABLE_FRAME_CAPTURE
+    PMW3360_captureFrame(frame);
+#endif
+    PMW3360_read(&data);
+    PMW3360_shutdown();
+
+    failed = observer_report(&padded);
+    printf("init with SROM upload  %10.2f ms\n", init/1e6);
+    printf("PMW3360_read           %10.0f reads/s\n", READS*1e9/read);
+    printf("PMW3360_readMotion     %10.0f reads/s\n", READS*1e9/readMotion);
+#if PMW3360_SENSOR_COUNT > 1
+    printf("PMW3360_readPair       %10.0f pairs/s\n", READS*1e9/readPair);
+    if (unlatched) {
+        printf("PMW3360_readPair       %10u reads without latched motion\n", (unsigned)unlatched);
+        failed++;
+    }
+#endif
+    // Exit with 1 when a minimum is violated, 2 when the port only wastes bus time
+    if (failed) {
+        printf("\nport FAILED conformance\n");
+        return 1;
+    }
+    if (padded) {
+        printf("\nport conforms, padded timings cost bus time\n");
+        return 2;
+    }
+    printf("\nport conforms\n");
+
+    return 0;
+}
@@ -0,0 +1,451 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "PMW3360.h"
+#include "PMW3360_firmware.h"
+#include "observer.h"
+
+// A rule is reported as padded when its shortest observation exceeds the minimum by half plus 2us
+#define OBSERVER_PAD_NS(spec)   ((spec) + (spec)/2 + 2000)
+
+// Transaction kinds, decided by the address byte
+#define OBSERVER_NONE           0
+#define OBSERVER_WRITE          1
+#define OBSERVER_READ           2
+#define OBSERVER_MOTION_BURST   3
+#define OBSERVER_RAW_BURST      4
+#define OBSERVER_SROM_LOAD      5
+
+// Chip select lines observed, one simulated sensor behind each
+#define OBSERVER_LINES          2
+
+static const struct
+{
+    const char *name;
+    uint64_t spec;              // Minimum in nanoseconds
+} observer_rules[OBSERVER_RULES] = {
+    { "tNCS-SCLK", 120 },
+    { "tSCLK-NCS read", 120 },
+    { "tSCLK-NCS write", 35000 },
+    { "tSRAD", 160000 },
+    { "tSRAD_MOTBR", 35000 },
+    { "tSWW/tSWR", 180000 },
+    { "tSRW/tSRR", 20000 },
+    { "tBEXIT", 1000 },
+    { "SROM load byte", 15000 },
+    { "SROM load exit", 200000 },
+    { "raw data byte", 15000 },
+};
+
+/*
+ * One chip select line: its bus state of the current and the previous
+ * transaction, and the simulated sensor behind it.
+ */
+typedef struct observer_line
+{
+    bool low;
+    uint64_t csFall;
+    uint64_t csRise;
+    uint64_t lastByteEnd;
+    uint32_t index;
+    uint8_t kind;
+    uint8_t address;
+    uint8_t prevKind;
+    uint64_t prevByteEnd;
+
+    uint8_t regs[128];
+    uint32_t writes;
+    uint32_t sromLoads;
+    bool latched;
+} observer_line;
+
+static struct
+{
+    uint64_t now;
+    uint64_t byteTime;
+    bool settled;
+    bool polarityError;
+    bool selectError;
+    bool keepFirmware;
+    uint64_t sromLoad;
+
+    // Motion bursts answered on line 0 with an injected pattern instead of the sensor's
+    uint8_t inject[12];
+    uint32_t injectCount;
+
+    // Lines and the one whose chip select is low, if any
+    observer_line lines[OBSERVER_LINES];
+    observer_line *active;
+
+    // Shortest and longest observation and number of violations per rule
+    uint64_t min[OBSERVER_RULES];
+    uint64_t max[OBSERVER_RULES];
+    uint32_t count[OBSERVER_RULES];
+    uint32_t failed[OBSERVER_RULES];
+} observer;
+
+/*
+ * Record one observation of a timing rule.
+ */
+static void observer_check(observer_rule rule, uint64_t ns)
+{
+    if (observer.count[rule] == 0 || ns < observer.min[rule]) {
+        observer.min[rule] = ns;
+    }
+    if (ns > observer.max[rule]) {
+        observer.max[rule] = ns;
+    }
+    observer.count[rule]++;
+    if (ns < observer_rules[rule].spec) {
+        observer.failed[rule]++;
+    }
+
+    return;
+}
+
+/*
+ * Power-up state of a simulated sensor.
+ */
+static void observer_powerUp(observer_line *line)
+{
+    memset(line->regs, 0, sizeof(line->regs));
+    line->regs[PMW3360_REG_PRODUCT_ID] = 0x42;
+    line->regs[PMW3360_REG_REVISION_ID] = 0x01;
+    line->regs[PMW3360_REG_INVERSE_PRODUCT_ID] = 0xbd;
+    line->regs[PMW3360_REG_CONFIG1] = 0x31;
+    line->regs[PMW3360_REG_CONFIG2] = 0x20;
+    line->regs[PMW3360_REG_RUN_DOWNSHIFT] = 0x32;
+    line->regs[PMW3360_REG_REST1_DOWNSHIFT] = 0x1f;
+    line->regs[PMW3360_REG_REST2_RATE_LOWER] = 0x63;
+    line->regs[PMW3360_REG_REST2_DOWNSHIFT] = 0xbc;
+    line->regs[PMW3360_REG_REST3_RATE_LOWER] = 0xf3;
+    line->regs[PMW3360_REG_REST3_RATE_UPPER] = 0x01;
+    line->regs[PMW3360_REG_LIFT_CONFIG] = 0x02;
+
+    return;
+}
+
+void observer_reset(void)
+{
+    uint8_t i;
+
+    memset(&observer, 0, sizeof(observer));
+    observer.byteTime = 8000;
+    observer.settled = true;
+    for (i = 0; i < OBSERVER_LINES; i++) {
+        observer_powerUp(&observer.lines[i]);
+    }
+
+    return;
+}
+
+uint64_t observer_now(void)
+{
+    return observer.now;
+}
+
+void observer_delay(uint64_t ns)
+{
+    observer.now += ns;
+
+    return;
+}
+
+void observer_setClock(uint32_t hz)
+{
+    observer.byteTime = hz ? 8000000000ull/hz : 0;
+
+    return;
+}
+
+void observer_keepFirmware(bool keep)
+{
+    observer.keepFirmware = keep;
+
+    return;
+}
+
+void observer_injectBursts(const uint8_t *burst, uint32_t count)
+{
+    memcpy(observer.inject, burst, sizeof(observer.inject));
+    observer.injectCount = count;
+
+    return;
+}
+
+void observer_setPolarity(bool settled)
+{
+    observer.settled = settled;
+
+    return;
+}
+
+void observer_cs(uint8_t line, bool high)
+{
+    observer_line *l;
+
+    if (line >= OBSERVER_LINES || high == !observer.lines[line].low) {
+        return;
+    }
+    l = &observer.lines[line];
+
+    if (!high) {
+        // Starting a transaction while the clock idles at the wrong level corrupts the first bit
+        if (!observer.settled) {
+            observer.polarityError = true;
+        }
+
+        // Two sensors selected at once both drive MISO
+        if (observer.active) {
+            observer.selectError = true;
+        }
+        observer.active = l;
+        l->low = true;
+        l->csFall = observer.now;
+        l->index = 0;
+        l->kind = OBSERVER_NONE;
+        return;
+    }
+
+    l->low = false;
+    l->csRise = observer.now;
+    if (observer.active == l) {
+        observer.active = NULL;
+    }
+    if (l->kind == OBSERVER_MOTION_BURST) {
+        l->latched = false;
+        if (l == &observer.lines[0] && l->index > 1 && observer.injectCount > 0) {
+            observer.injectCount--;
+        }
+    }
+    if (l->index > 0) {
+        // Writes need the longer hold so the sensor latches the data byte
+        observer_check(l->kind == OBSERVER_WRITE ? OBSERVER_SCLK_NCS_WRITE : OBSERVER_SCLK_NCS_READ,
+                       observer.now - l->lastByteEnd);
+
+        // The sensor runs the uploaded firmware once the whole image arrived
+        if (l->kind == OBSERVER_SROM_LOAD && l->index == PMW3360_FIRMWARE_SIZE + 1) {
+            l->regs[PMW3360_REG_SROM_ID] = 0x04;
+            l->sromLoads++;
+            observer.sromLoad = observer.now - l->csFall;
+        }
+        l->prevKind = l->kind;
+        l->prevByteEnd = l->lastByteEnd;
+    }
+
+    return;
+}
+
+/*
+ * Check the spacing from the previous transaction, on the first byte of a new one.
+ */
+static void observer_begin(observer_line *l, uint64_t start)
+{
+    observer_check(OBSERVER_NCS_SCLK, start - l->csFall);
+
+    switch (l->prevKind) {
+    case OBSERVER_WRITE:
+        observer_check(OBSERVER_SWW_SWR, start - l->prevByteEnd);
+        break;
+    case OBSERVER_READ:
+        observer_check(OBSERVER_SRW_SRR, start - l->prevByteEnd);
+        break;
+    case OBSERVER_MOTION_BURST:
+    case OBSERVER_RAW_BURST:
+        observer_check(OBSERVER_BEXIT, l->csFall - l->csRise);
+        break;
+    case OBSERVER_SROM_LOAD:
+        observer_check(OBSERVER_LOAD_EXIT, start - l->prevByteEnd);
+        break;
+    default:
+        break;
+    }
+
+    return;
+}
+
+/*
+ * Answer one byte of the current transaction like the sensor would.
+ */
+static uint8_t observer_sensor(observer_line *l, uint8_t tx, uint64_t gap)
+{
+    uint32_t i = l->index;
+
+    if (i == 0) {
+        l->address = tx & 0x7f;
+        if (tx & 0x80) {
+            l->kind = l->address == PMW3360_REG_SROM_LOAD_BURST ? OBSERVER_SROM_LOAD : OBSERVER_WRITE;
+        }
+        else if (l->address == PMW3360_REG_MOTION_BURST) {
+            l->kind = OBSERVER_MOTION_BURST;
+        }
+        else if (l->address == PMW3360_REG_RAW_DATA_BURST) {
+            l->kind = OBSERVER_RAW_BURST;
+        }
+        else {
+            l->kind = OBSERVER_READ;
+        }
+        return 0;
+    }
+
+    switch (l->kind) {
+    case OBSERVER_WRITE:
+        if (i == 1) {
+            if (l->address == PMW3360_REG_POWER_UP_RESET && tx == 0x5a) {
+                uint8_t sromId = l->regs[PMW3360_REG_SROM_ID];
+
+                observer_powerUp(l);
+                if (observer.keepFirmware) {
+                    l->regs[PMW3360_REG_SROM_ID] = sromId;
+                }
+            }
+            else {
+                l->regs[l->address] = tx;
+            }
+            l->latched = l->address == PMW3360_REG_MOTION_BURST || l->latched;
+            l->writes++;
+        }
+        return 0;
+    case OBSERVER_SROM_LOAD:
+        observer_check(OBSERVER_LOAD, gap);
+        return 0;
+    case OBSERVER_MOTION_BURST:
+        if (i == 1) {
+            observer_check(OBSERVER_SRAD_MOTBR, gap);
+        }
+        {
+            // Motion with one count on each axis and plausible surface values, only once latched by a write
+            static const uint8_t burst[12] = { 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x40, 0x30, 0x80, 0x10, 0x20, 0x01 };
+            if (l == &observer.lines[0] && observer.injectCount > 0) {
+                return i <= sizeof(observer.inject) ? observer.inject[i - 1] : 0;
+            }
+            if (!l->latched) {
+                return 0;
+            }
+            return i <= sizeof(burst) ? burst[i - 1] : 0;
+        }
+    case OBSERVER_RAW_BURST:
+        observer_check(i == 1 ? OBSERVER_SRAD : OBSERVER_RAW_BYTE, gap);
+        return (uint8_t)(i - 1);
+    case OBSERVER_READ:
+        if (i == 1) {
+            observer_check(OBSERVER_SRAD, gap);
+            return l->regs[l->address];
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+uint8_t observer_exchange(uint8_t tx)
+{
+    observer_line *l = observer.active;
+    uint64_t start = observer.now;
+    uint8_t rx = 0xff;
+
+    observer.now += observer.byteTime;
+    if (!l) {
+        // Bytes clocked without chip select only move the clock line
+        return rx;
+    }
+
+    if (l->index == 0) {
+        observer_begin(l, start);
+    }
+    rx = observer_sensor(l, tx, start - l->lastByteEnd);
+    l->lastByteEnd = observer.now;
+    l->index++;
+
+    return rx;
+}
+
+uint8_t observer_register(uint8_t address)
+{
+    return observer_registerOf(0, address);
+}
+
+uint8_t observer_registerOf(uint8_t line, uint8_t address)
+{
+    return line < OBSERVER_LINES ? observer.lines[line].regs[address & 0x7f] : 0;
+}
+
+uint32_t observer_writes(void)
+{
+    return observer.lines[0].writes;
+}
+
+uint32_t observer_writesOf(uint8_t line)
+{
+    return line < OBSERVER_LINES ? observer.lines[line].writes : 0;
+}
+
+uint32_t observer_sromLoads(void)
+{
+    return observer.lines[0].sromLoads;
+}
+
+int observer_report(int *padded)
+{
+    int failed = 0;
+    uint8_t i;
+    const char *result;
+
+    printf("%-16s %10s %10s %10s %8s  %s\n", "timing", "min (us)", "seen (us)", "max (us)", "count", "result");
+    for (i = 0; i < OBSERVER_RULES; i++) {
+        if (observer.count[i] == 0) {
+            result = "not exercised";
+        }
+        else if (observer.failed[i]) {
+            result = "FAIL";
+            failed++;
+        }
+        else if (observer.min[i] > OBSERVER_PAD_NS(observer_rules[i].spec)) {
+            result = "padded";
+            (*padded)++;
+        }
+        else {
+            result = "ok";
+        }
+        printf("%-16s %10.2f %10.2f %10.2f %8u  %s\n", observer_rules[i].name, observer_rules[i].spec/1000.0,
+               observer.min[i]/1000.0, observer.max[i]/1000.0, (unsigned)observer.count[i], result);
+    }
+
+    printf("%-16s %43s  %s\n", "clock polarity", "", observer.polarityError ? "FAIL" : "ok");
+    if (observer.polarityError) {
+        failed++;
+    }
+    printf("%-16s %43s  %s\n", "chip select", "", observer.selectError ? "FAIL" : "ok");
+    if (observer.selectError) {
+        failed++;
+    }
+
+    printf("\nSROM load burst        %10.2f ms\n", observer.sromLoad/1e6);
+
+    return failed;
+}
@@ -0,0 +1,147 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OBSERVER_H__
+#define OBSERVER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Simulated SPI bus observer with a minimal PMW3360 behind it. The platform
+ * stand-ins of each port report chip select edges, byte exchanges and time
+ * spent in delays. The observer checks the bus timing of every transaction
+ * against the sensor's minimums and answers like a sensor, so the driver
+ * can initialize and read. Time only advances through delays and byte
+ * clocks, CPU time between calls is not modelled.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Timing rules checked on the bus
+typedef enum observer_rule
+{
+    OBSERVER_NCS_SCLK = 0,      // Chip select fall to first clock
+    OBSERVER_SCLK_NCS_READ,     // Last clock to chip select rise, reads and bursts
+    OBSERVER_SCLK_NCS_WRITE,    // Last clock to chip select rise, register writes
+    OBSERVER_SRAD,              // Read address to data
+    OBSERVER_SRAD_MOTBR,        // Motion burst address to data
+    OBSERVER_SWW_SWR,           // Write to next transaction
+    OBSERVER_SRW_SRR,           // Read to next transaction
+    OBSERVER_BEXIT,             // Chip select high after a burst
+    OBSERVER_LOAD,              // Between SROM load bytes
+    OBSERVER_LOAD_EXIT,         // SROM load to next transaction
+    OBSERVER_RAW_BYTE,          // Between raw data bytes
+    OBSERVER_RULES
+} observer_rule;
+
+/**
+ * @brief Reset the bus and the simulated sensor, time starts at zero.
+ */
+void observer_reset(void);
+
+/**
+ * @brief Current simulated time in nanoseconds.
+ */
+uint64_t observer_now(void);
+
+/**
+ * @brief Advance the simulated time.
+ */
+void observer_delay(uint64_t ns);
+
+/**
+ * @brief Set the SPI clock used to time byte exchanges.
+ */
+void observer_setClock(uint32_t hz);
+
+/**
+ * @brief Keep the uploaded firmware across a power-up reset, as a sensor that stayed powered would.
+ */
+void observer_keepFirmware(bool keep);
+
+/**
+ * @brief Answer the next motion bursts on line 0 with a fixed 12-byte pattern, as a faulty bus would.
+ *
+ * @param burst Bytes returned in place of the sensor's burst.
+ * @param count Number of bursts to corrupt.
+ */
+void observer_injectBursts(const uint8_t *burst, uint32_t count);
+
+/**
+ * @brief Report whether the serial clock idles at the level of SPI mode 3.
+ *
+ * Ports whose controller leaves the clock level undefined until the first
+ * byte report false after configuring and true once a byte was clocked.
+ */
+void observer_setPolarity(bool settled);
+
+/**
+ * @brief Report the level of chip select line 0 or 1, each has its own simulated sensor.
+ */
+void observer_cs(uint8_t line, bool high);
+
+/**
+ * @brief Exchange one byte, returns the byte the sensor drives on MISO.
+ */
+uint8_t observer_exchange(uint8_t tx);
+
+/**
+ * @brief Current value of a register of the simulated sensor on line 0.
+ */
+uint8_t observer_register(uint8_t address);
+
+/**
+ * @brief Current value of a register of the simulated sensor on a line.
+ */
+uint8_t observer_registerOf(uint8_t line, uint8_t address);
+
+/**
+ * @brief Number of register writes the simulated sensor on line 0 received, including resets.
+ */
+uint32_t observer_writes(void);
+
+/**
+ * @brief Number of register writes the simulated sensor on a line received, including resets.
+ */
+uint32_t observer_writesOf(uint8_t line);
+
+/**
+ * @brief Number of complete firmware images the simulated sensor on line 0 received.
+ */
+uint32_t observer_sromLoads(void);
+
+/**
+ * @brief Print the timing report, returns the number of failed rules.
+ *
+ * @param padded Incremented for every rule met with a wide margin.
+ */
+int observer_report(int *padded);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //OBSERVER_H__
@@ -0,0 +1,75 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_MSP430_H__
+#define SIM_MSP430_H__
+
+#include <stdint.h>
+
+// Stand-ins for the MSP430FR5994 registers used by the port, implemented on the bus observer in
+// sim_msp430.c. Every register access first applies the effect of the earlier writes to the bus,
+// so the observer sees pin and peripheral changes in the order the port makes them.
+
+#define BIT0            0x01
+#define BIT1            0x02
+#define BIT2            0x04
+#define BIT3            0x08
+#define BIT4            0x10
+
+#define UCSWRST         0x0001
+#define UCSSEL__SMCLK   0x0080
+#define UCSYNC          0x0100
+#define UCMST           0x0800
+#define UCMSB           0x2000
+#define UCCKPL          0x4000
+#define UCRXIFG         0x0001
+#define UCTXIFG         0x0002
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern volatile uint8_t sim_P5OUT, sim_P5DIR, sim_P5SEL0, sim_P5SEL1;
+extern volatile uint16_t sim_UCB1CTLW0, sim_UCB1BRW, sim_UCB1TXBUF;
+
+volatile uint8_t *sim_msp430_reg8(volatile uint8_t *reg);
+volatile uint16_t *sim_msp430_reg16(volatile uint16_t *reg);
+void sim_msp430_delay(uint32_t cycles);
+uint8_t sim_msp430_receive(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define P5OUT                   (*sim_msp430_reg8(&sim_P5OUT))
+#define P5DIR                   (*sim_msp430_reg8(&sim_P5DIR))
+#define P5SEL0                  (*sim_msp430_reg8(&sim_P5SEL0))
+#define P5SEL1                  (*sim_msp430_reg8(&sim_P5SEL1))
+#define UCB1CTLW0               (*sim_msp430_reg16(&sim_UCB1CTLW0))
+#define UCB1BRW                 (*sim_msp430_reg16(&sim_UCB1BRW))
+#define UCB1TXBUF               (*sim_msp430_reg16(&sim_UCB1TXBUF))
+#define UCB1IFG                 (UCRXIFG | UCTXIFG)
+#define UCB1RXBUF               (sim_msp430_receive())
+#define __delay_cycles(x)       (sim_msp430_delay(x))
+
+#endif //SIM_MSP430_H__
@@ -0,0 +1,149 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+#include "sim_linux.h"
+#include "observer.h"
+
+// Controllers assert chip select half a clock period before the first clock and release it half a
+// period after the last one
+#define SIM_CS_HALF_NS(hz)      (500000000u/(hz))
+
+// Chip select high time between transfers with cs_change, the kernel's default cs_change_delay
+#define SIM_CS_CHANGE_NS        10000
+
+// Cost of reading the clock, busy waits advance time through it
+#define SIM_CLOCK_NS            100
+
+static uint32_t sim_linux_speed;
+
+// Injected faults
+static int sim_linux_failOpen;
+static int sim_linux_messages = -1;
+
+void sim_linux_fault(int failOpen, int messages)
+{
+    sim_linux_failOpen = failOpen;
+    sim_linux_messages = messages;
+}
+
+int sim_linux_open(const char *path, int flags)
+{
+    (void)flags;
+    if (sim_linux_failOpen) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    // One file descriptor per chip select, spidevB.C
+    return path[sizeof("/dev/spidev0.0") - 2] == '1' ? 4 : 3;
+}
+
+int sim_linux_close(int fd)
+{
+    (void)fd;
+
+    return 0;
+}
+
+int sim_linux_ioctl(int fd, unsigned long request, void *arg)
+{
+    const struct spi_ioc_transfer *xfer = arg;
+    uint8_t line = fd == 4 ? 1 : 0;
+    uint32_t count, i, j;
+    uint32_t speed = sim_linux_speed;
+    uint8_t rx;
+
+    if (request == SPI_IOC_WR_MODE) {
+        // The controller drives the idle level of the clock as soon as the mode is set
+        observer_setPolarity((*(const uint8_t *)arg & SPI_CPOL) != 0);
+        return 0;
+    }
+    if (request == SPI_IOC_WR_MAX_SPEED_HZ) {
+        sim_linux_speed = *(const uint32_t *)arg;
+        return 0;
+    }
+    if (_IOC_TYPE(request) != SPI_IOC_MAGIC || _IOC_NR(request) != 0) {
+        return 0;
+    }
+
+    // A failing controller rejects the message before touching the bus
+    if (sim_linux_messages == 0) {
+        errno = EIO;
+        return -1;
+    }
+    if (sim_linux_messages > 0) {
+        sim_linux_messages--;
+    }
+
+    // Run the message, chip select stays low across transfers unless cs_change asks otherwise
+    count = _IOC_SIZE(request)/sizeof(struct spi_ioc_transfer);
+    observer_cs(line, false);
+    for (i = 0; i < count; i++) {
+        speed = xfer[i].speed_hz ? xfer[i].speed_hz : sim_linux_speed;
+        observer_setClock(speed);
+        if (i == 0 || xfer[i - 1].cs_change) {
+            observer_delay(SIM_CS_HALF_NS(speed));
+        }
+        for (j = 0; j < xfer[i].len; j++) {
+            rx = observer_exchange(xfer[i].tx_buf ? ((const uint8_t *)(uintptr_t)xfer[i].tx_buf)[j] : 0);
+            if (xfer[i].rx_buf) {
+                ((uint8_t *)(uintptr_t)xfer[i].rx_buf)[j] = rx;
+            }
+        }
+        observer_delay((uint64_t)xfer[i].delay_usecs*1000);
+        if (xfer[i].cs_change && i + 1 < count) {
+            observer_delay(SIM_CS_HALF_NS(speed));
+            observer_cs(line, true);
+            observer_delay(SIM_CS_CHANGE_NS);
+            observer_cs(line, false);
+        }
+    }
+
+    // cs_change on the last transfer keeps chip select low for the next message
+    if (count > 0 && !xfer[count - 1].cs_change) {
+        observer_delay(SIM_CS_HALF_NS(speed));
+        observer_cs(line, true);
+    }
+
+    return 0;
+}
+
+int sim_linux_clock_gettime(clockid_t clock, struct timespec *now)
+{
+    uint64_t ns;
+
+    (void)clock;
+    observer_delay(SIM_CLOCK_NS);
+    ns = observer_now();
+    now->tv_sec = (time_t)(ns/1000000000);
+    now->tv_nsec = (long)(ns%1000000000);
+
+    return 0;
+}
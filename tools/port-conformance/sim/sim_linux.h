@@ -0,0 +1,40 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_LINUX_H__
+#define SIM_LINUX_H__
+
+#include <time.h>
+
+// Stand-ins for the system calls of the spidev port, force included and selected through
+// the PMW3360_SPIDEV_* hooks, implemented on the bus observer in sim_linux.c
+
+int sim_linux_open(const char *path, int flags);
+int sim_linux_close(int fd);
+int sim_linux_ioctl(int fd, unsigned long request, void *arg);
+int sim_linux_clock_gettime(clockid_t clock, struct timespec *now);
+
+// Make open fail, and every SPI_IOC_MESSAGE after the given number of messages (-1 for none)
+void sim_linux_fault(int failOpen, int messages);
+
+#endif //SIM_LINUX_H__
@@ -0,0 +1,78 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "msp430.h"
+#include "observer.h"
+
+// MCLK and SMCLK frequency assumed by the port
+#define SIM_MCLK        8000000
+
+// Chip select bits of the port
+#define SIM_CS_BIT      BIT3
+#define SIM_CS2_BIT     BIT4
+
+volatile uint8_t sim_P5OUT, sim_P5DIR, sim_P5SEL0, sim_P5SEL1;
+volatile uint16_t sim_UCB1CTLW0 = UCSWRST, sim_UCB1BRW, sim_UCB1TXBUF;
+
+/*
+ * Apply the port's register writes to the bus, a pin only drives low as an output.
+ */
+static void sim_msp430_sync(void)
+{
+    bool running = (sim_UCB1CTLW0 & UCSWRST) == 0;
+
+    observer_setClock(running && sim_UCB1BRW ? SIM_MCLK/sim_UCB1BRW : 0);
+    observer_setPolarity(running && (sim_UCB1CTLW0 & UCCKPL));
+    observer_cs(0, !((sim_P5DIR & SIM_CS_BIT) && !(sim_P5OUT & SIM_CS_BIT)));
+    observer_cs(1, !((sim_P5DIR & SIM_CS2_BIT) && !(sim_P5OUT & SIM_CS2_BIT)));
+}
+
+volatile uint8_t *sim_msp430_reg8(volatile uint8_t *reg)
+{
+    sim_msp430_sync();
+
+    return reg;
+}
+
+volatile uint16_t *sim_msp430_reg16(volatile uint16_t *reg)
+{
+    sim_msp430_sync();
+
+    return reg;
+}
+
+void sim_msp430_delay(uint32_t cycles)
+{
+    sim_msp430_sync();
+    observer_delay((uint64_t)cycles*1000000000/SIM_MCLK);
+}
+
+uint8_t sim_msp430_receive(void)
+{
+    sim_msp430_sync();
+
+    return observer_exchange((uint8_t)sim_UCB1TXBUF);
+}
@@ -0,0 +1,119 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Brent Peterson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "observer.h"
+
+// Chip select pins of the port
+#define SIM_PIN_CS      21
+#define SIM_PIN_CS2     17
+
+void sleep_us(uint64_t us)
+{
+    observer_delay(us*1000);
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)(observer_now()/1000);
+}
+
+void gpio_init(uint gpio)
+{
+    (void)gpio;
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    if (gpio == SIM_PIN_CS || gpio == SIM_PIN_CS2) {
+        observer_cs(gpio == SIM_PIN_CS ? 0 : 1, value);
+    }
+}
+
+void gpio_set_function(uint gpio, int fn)
+{
+    (void)gpio;
+    (void)fn;
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate)
+{
+    (void)spi;
+    observer_setClock(baudrate);
+
+    return baudrate;
+}
+
+void spi_deinit(spi_inst_t *spi)
+{
+    (void)spi;
+}
+
+void spi_set_format(spi_inst_t *spi, uint bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order)
+{
+    (void)spi;
+    (void)bits;
+    (void)cpha;
+    (void)order;
+
+    // The PL022 only drives the new clock idle level once it has clocked a byte
+    if (cpol == SPI_CPOL_1) {
+        observer_setPolarity(false);
+    }
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len)
+{
+    size_t i;
+
+    (void)spi;
+    for (i = 0; i < len; i++) {
+        dst[i] = observer_exchange(src[i]);
+        observer_setPolarity(true);
+    }
+
+    return (int)len;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+    size_t i;
+
+    (void)spi;
+    for (i = 0; i < len; i++) {
+        observer_exchange(src[i]);
+        observer_setPolarity(true);
+    }
+
+    return (int)len;
+}